@@ -0,0 +1,175 @@
+#include "avl_tree/avl_tree.hpp"
+#include "red_black_tree/red_black_tree.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace csb::bench
+{
+    namespace
+    {
+        constexpr int key_count = 500000;
+        constexpr int lookups = 1000000;
+
+        /*
+         * n draws of the keys 0 to key_count - 1 where the rank r key comes
+         * up in proportion to 1 / r. Ranks are shuffled onto keys so the
+         * popular ones are scattered through the tree
+         */
+        std::vector<int> zipfian(int n, unsigned seed)
+        {
+            std::vector<double> cdf(key_count);
+            double total = 0;
+            for (int r = 0; r != key_count; ++r)
+            {
+                total += 1.0 / (r + 1);
+                cdf[r] = total;
+            }
+
+            std::vector<int> key_of_rank(key_count);
+            std::iota(key_of_rank.begin(), key_of_rank.end(), 0);
+            std::shuffle(key_of_rank.begin(), key_of_rank.end(),
+                         std::mt19937(7));
+
+            std::mt19937 gen(seed);
+            std::uniform_real_distribution<double> dis(0, total);
+            std::vector<int> keys;
+            for (int i = 0; i != n; ++i)
+            {
+                auto const rank =
+                    std::lower_bound(cdf.begin(), cdf.end(), dis(gen)) -
+                    cdf.begin();
+                keys.push_back(key_of_rank[std::min<std::size_t>(
+                    rank, key_count - 1)]);
+            }
+            return keys;
+        }
+
+        std::vector<int> shuffled(unsigned seed)
+        {
+            std::vector<int> keys(key_count);
+            std::iota(keys.begin(), keys.end(), 0);
+            std::shuffle(keys.begin(), keys.end(), std::mt19937(seed));
+            return keys;
+        }
+
+        template <typename Tree> Tree fill(std::vector<int> const &keys)
+        {
+            Tree tree;
+            for (auto k : keys)
+            {
+                tree.add(k);
+            }
+            return tree;
+        }
+
+        template <typename Tree>
+        std::size_t count_found(Tree const &tree, std::vector<int> const &p)
+        {
+            std::size_t found = 0;
+            for (auto k : p)
+            {
+                found += tree.contains(k);
+            }
+            return found;
+        }
+
+        /** nodes visited on average to find each of probes, and at most */
+        template <typename Tree>
+        void report_depth(std::string const &name, Tree const &tree,
+                          std::vector<int> const &probes)
+        {
+            std::size_t total = 0;
+            std::size_t deepest = 0;
+            for (auto k : probes)
+            {
+                std::size_t depth = 1;
+                for (auto n = &tree.find(k).node(); n->parent != nullptr;
+                     n = n->parent)
+                {
+                    ++depth;
+                }
+                total += depth;
+                deepest = std::max(deepest, depth);
+            }
+            std::cout << name << ": " << tree.size() << " keys, "
+                      << double(total) / probes.size()
+                      << " nodes per lookup on average, " << deepest
+                      << " at most\n";
+        }
+
+        template <typename Tree>
+        void compare(std::string const &name, std::string const &input,
+                     std::vector<int> const &keys,
+                     std::vector<int> const &probes)
+        {
+            auto const tree = fill<Tree>(keys);
+            report_depth(name + " " + input, tree, probes);
+
+            BENCHMARK(name + " add, " + input)
+            {
+                return fill<Tree>(keys).size();
+            };
+
+            BENCHMARK(name + " 1M contains, " + input)
+            {
+                return count_found(tree, probes);
+            };
+        }
+
+        /*
+         * probes that all hit, in the same proportions as the keys of
+         * the tree were inserted
+         */
+        std::vector<int> hits_of(std::vector<int> const &keys, unsigned seed)
+        {
+            std::mt19937 gen(seed);
+            std::uniform_int_distribution<std::size_t> dis(0, keys.size() - 1);
+            std::vector<int> p;
+            for (int i = 0; i != lookups; ++i)
+            {
+                p.push_back(keys[dis(gen)]);
+            }
+            return p;
+        }
+    } // namespace
+
+    TEST_CASE("avl vs red black trees on random keys", "[benchmark]")
+    {
+        auto const keys = shuffled(1);
+        auto const probes = hits_of(keys, 2);
+        compare<avl_tree<int>>("avl_tree", "500K random keys", keys, probes);
+        compare<red_black_tree<int>>("red_black_tree", "500K random keys",
+                                     keys, probes);
+    }
+
+    TEST_CASE("avl vs red black trees on sorted keys", "[benchmark]")
+    {
+        std::vector<int> keys(key_count);
+        std::iota(keys.begin(), keys.end(), 0);
+        auto const probes = hits_of(keys, 3);
+        compare<avl_tree<int>>("avl_tree", "500K sorted keys", keys, probes);
+        compare<red_black_tree<int>>("red_black_tree", "500K sorted keys",
+                                     keys, probes);
+    }
+
+    TEST_CASE("avl vs red black trees on zipfian keys", "[benchmark]")
+    {
+        // every key is in the tree, added in the order the popular ones
+        // first turn up, and looked up with the same skew
+        auto keys = zipfian(key_count, 4);
+        auto const rest = shuffled(5);
+        keys.insert(keys.end(), rest.begin(), rest.end());
+        auto const probes = zipfian(lookups, 6);
+        compare<avl_tree<int>>("avl_tree", "500K zipfian keys", keys, probes);
+        compare<red_black_tree<int>>("red_black_tree", "500K zipfian keys",
+                                     keys, probes);
+    }
+} // namespace csb::bench
@@ -0,0 +1,249 @@
+#ifndef CSB_AVL_TREE_HPP
+#define CSB_AVL_TREE_HPP
+
+#include <binary_tree/binary_tree.hpp>
+#include <binary_tree/tree_utils.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+namespace csb
+{
+    namespace impl
+    {
+        struct avl_node_meta_data
+        {
+            // the number of nodes on the longest path down from here. A
+            // tree of 255 levels would need more nodes than fit in memory
+            unsigned char height = 1;
+        };
+
+        template <typename Node> int avl_height(Node const *node)
+        {
+            return node == nullptr ? 0 : node->metadata().height;
+        }
+
+        /** how much taller node's right subtree is than its left */
+        template <typename T, typename M, typename A>
+        int balance_factor(binary_tree_node<T, M, A> const &node)
+        {
+            return avl_height(node.right.get()) - avl_height(node.left.get());
+        }
+
+        template <typename T, typename M, typename A>
+        void update_height(binary_tree_node<T, M, A> &node)
+        {
+            auto const l = avl_height(node.left.get());
+            auto const r = avl_height(node.right.get());
+            node.metadata().height =
+                static_cast<unsigned char>(1 + (l > r ? l : r));
+        }
+
+        /*
+         * keeps the heights of every node's two subtrees within one of each
+         * other. That bounds the height of the tree at about 1.44 log2(n),
+         * against 2 log2(n) for a red black tree, so searches are shorter
+         * at the cost of more rotations on insert and erase
+         */
+        struct avl_tree_balancing
+        {
+            using node_metadata_type = avl_node_meta_data;
+
+            template <typename T,
+                      typename AllocationPolicy = heap_allocation_policy>
+            using node_type =
+                binary_tree_node<T, node_metadata_type, AllocationPolicy>;
+
+            template <typename Node>
+            static typename Node::pointer
+            balance(typename Node::pointer root, Node *node)
+            {
+                Node *const parent = node->parent;
+                retrace(root, parent);
+                return root;
+            }
+
+            template <typename Node>
+            static typename Node::pointer
+            erase_node(typename Node::pointer root, Node &target,
+                       typename Node::pointer &removed)
+            {
+                // as for a red black tree, a target with two children swaps
+                // elements with its successor, which is removed instead
+                if (target.left != nullptr && target.right != nullptr)
+                {
+                    auto successor = leftmost(target.right.get());
+                    std::swap(target.t, successor->t);
+                    return erase_node(std::move(root), *successor, removed);
+                }
+
+                Node *const parent = target.parent;
+                auto &child =
+                    target.left != nullptr ? target.left : target.right;
+                root = detach(std::move(root), target, removed,
+                              std::move(child));
+                retrace(root, parent);
+                return root;
+            }
+
+            /** joins balance by height, which every node keeps */
+            template <typename Node> static std::size_t rank(Node const *root)
+            {
+                return avl_height(root);
+            }
+
+            /** children keep their own heights */
+            template <typename Node>
+            static std::size_t child_rank(Node const &node, std::size_t rank,
+                                          Node const *child)
+            {
+                (void)node;
+                (void)rank;
+                return avl_height(child);
+            }
+
+            /*
+             * joins left and right under mid, where everything in left is
+             * less than mid and everything in right is greater. If the two
+             * trees' heights are within one mid goes on top. Otherwise mid
+             * replaces the first node down the facing spine of the taller
+             * tree that is at most one taller than the shorter tree, taking
+             * that node and the shorter tree as its children, and the spine
+             * is retraced like after an insertion. O(|h1 - h2| + 1)
+             */
+            template <typename Node>
+            static ranked_tree<typename Node::pointer>
+            join(ranked_tree<typename Node::pointer> left,
+                 typename Node::pointer mid,
+                 ranked_tree<typename Node::pointer> right)
+            {
+                auto const left_height = avl_height(left.root.get());
+                auto const right_height = avl_height(right.root.get());
+                auto const m = mid.get();
+
+                if (left_height <= right_height + 1 &&
+                    right_height <= left_height + 1)
+                {
+                    adopt(*m, std::move(left.root), std::move(right.root));
+                    update_height(*m);
+                    return {std::move(mid), rank(m)};
+                }
+
+                auto const into_left = left_height > right_height;
+                auto &taller = into_left ? left.root : right.root;
+                auto &shorter = into_left ? right.root : left.root;
+                auto const target =
+                    (into_left ? right_height : left_height) + 1;
+
+                Node *parent = nullptr;
+                auto link = &taller;
+                while (avl_height(link->get()) > target)
+                {
+                    parent = link->get();
+                    link = into_left ? &parent->right : &parent->left;
+                }
+
+                if (into_left)
+                {
+                    adopt(*m, std::move(*link), std::move(shorter));
+                }
+                else
+                {
+                    adopt(*m, std::move(shorter), std::move(*link));
+                }
+                update_height(*m);
+                m->parent = parent;
+                *link = std::move(mid);
+                m->refresh_path();
+
+                retrace(taller, parent);
+                auto const height = rank(taller.get());
+                return {std::move(taller), height};
+            }
+
+            template <typename Node>
+            static void bulk_load_node(Node &node, std::size_t depth,
+                                       std::size_t height)
+            {
+                // the node's subtrees are already linked and have their
+                // heights, and a bulk loaded tree is always balanced
+                (void)depth;
+                (void)height;
+                update_height(node);
+            }
+
+          private:
+            /*
+             * walk up from n refreshing heights, rotating any node whose
+             * subtrees have drifted two apart. Stops as soon as a subtree
+             * comes out the same height it went in, nothing above it can
+             * have changed
+             */
+            template <typename Pointer, typename Node>
+            static void retrace(Pointer &root, Node *n)
+            {
+                while (n != nullptr)
+                {
+                    auto const before = avl_height(n);
+                    update_height(*n);
+
+                    auto const factor = balance_factor(*n);
+                    if (factor < -1 || factor > 1)
+                    {
+                        n = rotate(root, *n, factor);
+                    }
+
+                    if (avl_height(n) == before)
+                    {
+                        return;
+                    }
+                    n = n->parent;
+                }
+            }
+
+            /** rebalance the subtree under n, returning its new top */
+            template <typename Pointer, typename Node>
+            static Node *rotate(Pointer &root, Node &n, int factor)
+            {
+                Node *const parent = n.parent;
+                auto &link = parent == nullptr
+                                 ? root
+                                 : is_left_child(n) ? parent->left
+                                                    : parent->right;
+
+                if (factor < 0)
+                {
+                    link = balance_factor(*n.left) > 0
+                               ? left_right_rotate(std::move(link))
+                               : right_rotate(std::move(link));
+                }
+                else
+                {
+                    link = balance_factor(*n.right) < 0
+                               ? right_left_rotate(std::move(link))
+                               : left_rotate(std::move(link));
+                }
+
+                // only the nodes that moved have new subtrees, but after a
+                // double rotation that is all three of these
+                Node *const top = link.get();
+                update_height(*top->left);
+                update_height(*top->right);
+                update_height(*top);
+                return top;
+            }
+        };
+    } // namespace impl
+
+    template <typename T, typename Compare = std::less<T>>
+    using avl_tree = binary_tree<T, impl::avl_tree_balancing,
+                                 impl::heap_allocation_policy, Compare>;
+
+    template <typename T, typename Compare = std::less<T>>
+    using pooled_avl_tree = binary_tree<T, impl::avl_tree_balancing,
+                                        impl::pool_allocation_policy, Compare>;
+
+} // namespace csb
+
+#endif // CSB_AVL_TREE_HPP
@@ -0,0 +1,291 @@
+#include "avl_tree.hpp"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace csb
+{
+    namespace
+    {
+        /*
+         * the height of the subtree under n, checking on the way that every
+         * node's recorded height is right, that its subtrees' heights are
+         * within one and that its children point back at it. -1 if not
+         */
+        template <typename Node> int checked_height(Node const *n)
+        {
+            if (n == nullptr)
+            {
+                return 0;
+            }
+
+            for (Node const *child : {n->left.get(), n->right.get()})
+            {
+                if (child != nullptr && child->parent != n)
+                {
+                    return -1;
+                }
+            }
+
+            auto const l = checked_height(n->left.get());
+            auto const r = checked_height(n->right.get());
+            if (l < 0 || r < 0 || l - r > 1 || r - l > 1)
+            {
+                return -1;
+            }
+
+            auto const height = 1 + std::max(l, r);
+            return impl::avl_height(n) == height ? height : -1;
+        }
+
+        template <typename Tree> typename Tree::node_type const *
+        root_of(Tree const &tree)
+        {
+            if (tree.is_empty())
+            {
+                return nullptr;
+            }
+
+            typename Tree::node_type const *root = &tree.begin().node();
+            while (root->parent != nullptr)
+            {
+                root = root->parent;
+            }
+            return root;
+        }
+
+        template <typename Tree> bool is_valid_avl_tree(Tree const &tree)
+        {
+            return checked_height(root_of(tree)) >= 0 &&
+                   std::is_sorted(tree.begin(), tree.end());
+        }
+
+        // the tallest an avl tree of n nodes can be
+        int max_avl_height(std::size_t n)
+        {
+            return static_cast<int>(1.44 * std::log2(n + 2.0));
+        }
+    } // namespace
+
+    SCENARIO("avl tree insertion")
+    {
+        GIVEN("an avl tree built from increasing keys")
+        {
+            avl_tree<int> avl;
+            for (int i = 0; i != 1023; ++i)
+            {
+                avl.add(i);
+            }
+
+            THEN("it comes out perfectly balanced")
+            {
+                REQUIRE(is_valid_avl_tree(avl));
+                REQUIRE(impl::avl_height(root_of(avl)) == 10);
+            }
+        }
+
+        GIVEN("an avl tree built from decreasing keys")
+        {
+            avl_tree<int> avl;
+            for (int i = 1000; i != 0; --i)
+            {
+                avl.add(i);
+            }
+
+            THEN("it is balanced and ordered")
+            {
+                REQUIRE(is_valid_avl_tree(avl));
+                REQUIRE(avl.size() == 1000);
+                REQUIRE(*avl.begin() == 1);
+                REQUIRE(*avl.rbegin() == 1000);
+            }
+        }
+
+        GIVEN("an avl tree of a few keys")
+        {
+            avl_tree<int> avl{5, 3, 4};
+
+            THEN("a left right insertion is rotated twice")
+            {
+                auto const root = root_of(avl);
+                REQUIRE(root->t == 4);
+                REQUIRE(root->left->t == 3);
+                REQUIRE(root->right->t == 5);
+                REQUIRE(is_valid_avl_tree(avl));
+            }
+        }
+    }
+
+    SCENARIO("avl tree fuzzing")
+    {
+        GIVEN("an avl tree under random adds and erases")
+        {
+            avl_tree<int> avl;
+            std::set<int> expected;
+
+            std::mt19937 gen(25);
+            std::uniform_int_distribution<int> dis(0, 3000);
+            for (int round = 0; round != 20000; ++round)
+            {
+                auto const v = dis(gen);
+                if (round % 3 == 2)
+                {
+                    avl.erase(v);
+                    expected.erase(v);
+                }
+                else
+                {
+                    avl.add(v);
+                    expected.insert(v);
+                }
+            }
+
+            THEN("it is balanced and holds the right elements")
+            {
+                REQUIRE(is_valid_avl_tree(avl));
+                REQUIRE(avl.size() == expected.size());
+                REQUIRE(std::equal(avl.begin(), avl.end(), expected.begin(),
+                                   expected.end()));
+                REQUIRE(impl::avl_height(root_of(avl)) <=
+                        max_avl_height(avl.size()));
+            }
+
+            WHEN("it is drained smallest first")
+            {
+                while (!avl.is_empty())
+                {
+                    avl.erase(*avl.begin());
+                    if (avl.size() % 97 == 0)
+                    {
+                        REQUIRE(is_valid_avl_tree(avl));
+                    }
+                }
+
+                THEN("it ends up empty")
+                {
+                    REQUIRE(avl.size() == 0);
+                    REQUIRE(avl.begin() == avl.end());
+                }
+            }
+        }
+    }
+
+    SCENARIO("splitting and joining avl trees")
+    {
+        GIVEN("an avl tree of random values")
+        {
+            avl_tree<int> avl;
+            std::mt19937 gen(26);
+            std::uniform_int_distribution<int> dis(0, 100000);
+            for (int i = 0; i != 5000; ++i)
+            {
+                avl.add(dis(gen));
+            }
+
+            THEN("splitting at any point leaves two valid trees")
+            {
+                for (int at : {-1, 0, 1000, 50000, 99999, 100001})
+                {
+                    auto lower = avl;
+                    auto upper = lower.split(at);
+                    REQUIRE(is_valid_avl_tree(lower));
+                    REQUIRE(is_valid_avl_tree(upper));
+                    REQUIRE(lower.size() + upper.size() == avl.size());
+                    REQUIRE((lower.is_empty() || *lower.rbegin() < at));
+                    REQUIRE((upper.is_empty() || *upper.begin() >= at));
+
+                    auto const joined =
+                        avl_tree<int>::join(std::move(lower), std::move(upper));
+                    REQUIRE(is_valid_avl_tree(joined));
+                    REQUIRE(joined == avl);
+                }
+            }
+
+            THEN("joining it to a much smaller tree keeps it balanced")
+            {
+                auto lower = avl;
+                avl_tree<int> upper{200000, 200001, 200002};
+                auto const joined =
+                    avl_tree<int>::join(std::move(lower), std::move(upper));
+                REQUIRE(is_valid_avl_tree(joined));
+                REQUIRE(joined.size() == avl.size() + 3);
+            }
+        }
+    }
+
+    SCENARIO("bulk loading an avl tree")
+    {
+        GIVEN("sorted ranges of every size up to a few full levels")
+        {
+            THEN("from_sorted builds valid trees that stay valid")
+            {
+                for (int n = 0; n != 70; ++n)
+                {
+                    std::vector<int> sorted(n);
+                    std::iota(sorted.begin(), sorted.end(), 0);
+                    auto avl = avl_tree<int>::from_sorted(sorted.begin(),
+                                                          sorted.end());
+                    REQUIRE(is_valid_avl_tree(avl));
+                    REQUIRE(avl.size() == sorted.size());
+
+                    avl.add(-1);
+                    avl.erase(n / 2);
+                    REQUIRE(is_valid_avl_tree(avl));
+                }
+            }
+        }
+    }
+
+    SCENARIO("avl balancing under other policies")
+    {
+        GIVEN("an order statistic avl tree")
+        {
+            binary_tree<int,
+                        impl::order_statistic_policy<impl::avl_tree_balancing>>
+                avl;
+            for (int i = 0; i != 500; ++i)
+            {
+                avl.add((i * 7) % 500);
+            }
+            for (int i = 0; i < 500; i += 3)
+            {
+                avl.erase(i);
+            }
+
+            THEN("subtree sizes survive the rotations")
+            {
+                REQUIRE(is_valid_avl_tree(avl));
+                std::size_t i = 0;
+                for (auto it = avl.begin(); it != avl.end(); ++it, ++i)
+                {
+                    REQUIRE(avl.nth(i) == it);
+                }
+            }
+        }
+
+        GIVEN("a pooled avl tree")
+        {
+            pooled_avl_tree<int> avl;
+            for (int i = 0; i != 1000; ++i)
+            {
+                avl.add(i);
+            }
+            for (int i = 0; i < 1000; i += 2)
+            {
+                avl.erase(i);
+            }
+
+            THEN("only the odd elements remain, balanced")
+            {
+                REQUIRE(is_valid_avl_tree(avl));
+                REQUIRE(avl.size() == 500);
+                REQUIRE(*avl.begin() == 1);
+            }
+        }
+    }
+} // namespace csb
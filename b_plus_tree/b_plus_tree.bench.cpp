@@ -0,0 +1,134 @@
+#include "b_plus_tree/b_plus_tree.hpp"
+#include "red_black_tree/red_black_tree.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace csb::bench
+{
+    namespace
+    {
+        constexpr int lookups = 100000;
+        constexpr int ingest_size = 1000000;
+
+        /** the even numbers below 2n, in a random order */
+        std::vector<int> shuffled_keys(int n)
+        {
+            std::vector<int> keys;
+            for (int i = 0; i != n; ++i)
+            {
+                keys.push_back(2 * i);
+            }
+            std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+            return keys;
+        }
+
+        /** random keys over the same range, about half of them present */
+        std::vector<int> probes(int n)
+        {
+            std::mt19937 gen(11);
+            std::uniform_int_distribution<int> dis(0, 2 * n - 1);
+            std::vector<int> p;
+            for (int i = 0; i != lookups; ++i)
+            {
+                p.push_back(dis(gen));
+            }
+            return p;
+        }
+
+        template <typename Tree> Tree fill(std::vector<int> const &keys)
+        {
+            Tree tree;
+            for (auto k : keys)
+            {
+                tree.add(k);
+            }
+            return tree;
+        }
+
+        template <typename Tree>
+        int count_found(Tree const &tree, std::vector<int> const &p)
+        {
+            int found = 0;
+            for (auto k : p)
+            {
+                found += tree.contains(k);
+            }
+            return found;
+        }
+    } // namespace
+
+    // 100M keys would be the full size of our biggest index but the red
+    // black tree alone needs 4GB for it, 10M shows the trend
+    TEST_CASE("b_plus_tree vs red_black_tree lookups", "[benchmark]")
+    {
+        for (int n : {1000, 100000, 1000000, 10000000})
+        {
+            auto const keys = shuffled_keys(n);
+            auto const p = probes(n);
+            auto const suffix = ", " + std::to_string(n) + " keys";
+
+            {
+                auto const rb = fill<red_black_tree<int>>(keys);
+                BENCHMARK("red_black_tree 100K contains" + suffix)
+                {
+                    return count_found(rb, p);
+                };
+            }
+
+            auto const bp = fill<b_plus_tree<int>>(keys);
+            BENCHMARK("b_plus_tree 100K contains" + suffix)
+            {
+                return count_found(bp, p);
+            };
+
+            auto const wide = fill<b_plus_tree<int, std::less<int>, 512>>(keys);
+            BENCHMARK("b_plus_tree 512 byte nodes 100K contains" + suffix)
+            {
+                return count_found(wide, p);
+            };
+        }
+    }
+
+    TEST_CASE("b_plus_tree vs red_black_tree insert and scan", "[benchmark]")
+    {
+        auto const keys = shuffled_keys(ingest_size);
+
+        BENCHMARK("red_black_tree add, 1M random keys")
+        {
+            return fill<red_black_tree<int>>(keys).size();
+        };
+
+        BENCHMARK("b_plus_tree add, 1M random keys")
+        {
+            return fill<b_plus_tree<int>>(keys).size();
+        };
+
+        auto const rb = fill<red_black_tree<int>>(keys);
+        auto const bp = fill<b_plus_tree<int>>(keys);
+
+        BENCHMARK("red_black_tree iterate, 1M keys")
+        {
+            long long sum = 0;
+            for (auto k : rb)
+            {
+                sum += k;
+            }
+            return sum;
+        };
+
+        BENCHMARK("b_plus_tree iterate, 1M keys")
+        {
+            long long sum = 0;
+            for (auto k : bp)
+            {
+                sum += k;
+            }
+            return sum;
+        };
+    }
+} // namespace csb::bench
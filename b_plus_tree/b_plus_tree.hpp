@@ -0,0 +1,1000 @@
+#ifndef CSB_B_PLUS_TREE_HPP
+#define CSB_B_PLUS_TREE_HPP
+
+#include <core/compare.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace csb
+{
+    template <typename T, typename Compare = std::less<T>,
+              std::size_t NodeBytes = 256>
+    class b_plus_tree;
+
+    namespace impl
+    {
+        /** all a parent needs to know about a child it has not cast yet */
+        struct b_plus_node_base
+        {
+            std::uint16_t count = 0;
+        };
+
+        /*
+         * Slots is one more than the node's capacity so that an add can
+         * overflow it before it is split
+         */
+        template <typename T, std::size_t Slots>
+        struct b_plus_leaf : b_plus_node_base
+        {
+            using value_type = T;
+
+            std::array<T, Slots> keys;
+            b_plus_leaf *prev = nullptr;
+            b_plus_leaf *next = nullptr;
+        };
+
+        /*
+         * children[i] holds the keys k with keys[i - 1] <= k < keys[i], so a
+         * separator is never greater than anything to its right. It may be
+         * less though, erasing the smallest key of a leaf leaves it alone
+         */
+        template <typename T, std::size_t Slots>
+        struct b_plus_inner : b_plus_node_base
+        {
+            std::array<T, Slots> keys;
+            std::array<b_plus_node_base *, Slots + 1> children;
+        };
+
+        /** walks the linked leaves, a key at a time */
+        template <typename Leaf> class b_plus_tree_iterator
+        {
+          public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = typename Leaf::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = value_type const *;
+            using reference = value_type const &;
+
+            b_plus_tree_iterator &operator++()
+            {
+                if (++i == leaf->count)
+                {
+                    leaf = leaf->next;
+                    i = 0;
+                }
+                return *this;
+            }
+
+            b_plus_tree_iterator operator++(int)
+            {
+                auto cpy = *this;
+                ++(*this);
+                return cpy;
+            }
+
+            b_plus_tree_iterator &operator--()
+            {
+                if (leaf == nullptr)
+                {
+                    leaf = *last;
+                    i = leaf->count;
+                }
+                else if (i == 0)
+                {
+                    leaf = leaf->prev;
+                    i = leaf->count;
+                }
+                --i;
+                return *this;
+            }
+
+            b_plus_tree_iterator operator--(int)
+            {
+                auto tmp = *this;
+                --(*this);
+                return tmp;
+            }
+
+            reference operator*() const { return leaf->keys[i]; }
+
+            pointer operator->() const { return &leaf->keys[i]; }
+
+          private:
+            b_plus_tree_iterator(Leaf const *leaf, std::size_t i,
+                                 Leaf *const *last)
+                  : leaf(leaf), i(i), last(last)
+            {
+            }
+
+            Leaf const *leaf = nullptr;
+            std::size_t i = 0;
+            // the tree's last leaf, so that --end() works
+            Leaf *const *last = nullptr;
+
+            template <typename T, typename C, std::size_t N>
+            friend class csb::b_plus_tree;
+
+            friend bool operator==(b_plus_tree_iterator const &l,
+                                   b_plus_tree_iterator const &r)
+            {
+                return l.leaf == r.leaf && l.i == r.i;
+            }
+
+            friend bool operator!=(b_plus_tree_iterator const &l,
+                                   b_plus_tree_iterator const &r)
+            {
+                return !(l == r);
+            }
+        };
+
+        /*
+         * how many keys fit in the space left of a node, rounded down to a
+         * multiple of 4 for arithmetic keys so the in-node search runs in
+         * whole vector registers
+         */
+        template <typename T>
+        constexpr std::size_t b_plus_slots(std::size_t bytes,
+                                           std::size_t per_key)
+        {
+            auto const slots = bytes / per_key;
+            auto const rounded =
+                std::is_arithmetic_v<T> && slots >= 8 ? slots / 4 * 4 : slots;
+            return std::max<std::size_t>(rounded, 4);
+        }
+    } // namespace impl
+
+    /*
+     * An ordered set kept in a B+tree. Each node is around NodeBytes and
+     * holds many keys side by side, so a lookup touches one node per level
+     * of a tree that is a handful of levels deep, rather than a cache line
+     * per key like binary_tree. The elements all live in the leaves, which
+     * are linked to their neighbours so iteration is a walk along arrays.
+     *
+     * For arithmetic keys under std::less the search within a node counts
+     * the keys less than the one it is after over the whole node, unused
+     * slots hold the largest value so they never count. That is branch
+     * free and the compiler turns it into vector compares. Any other keys
+     * are binary searched.
+     *
+     * It has binary_tree's add / erase / find / contains surface, but as
+     * with std::vector any add or erase invalidates every iterator, the
+     * elements move between nodes as they split and merge
+     */
+    template <typename T, typename Compare, std::size_t NodeBytes>
+    class b_plus_tree
+    {
+      public:
+        static_assert(std::is_invocable_v<Compare const &, T const &,
+                                          T const &>,
+                      "Compare must be able to order two Ts in order for "
+                      "b_plus_tree to function properly");
+        static_assert(std::is_default_constructible_v<T> &&
+                          std::is_move_assignable_v<T>,
+                      "b_plus_tree keeps its elements in arrays, T must be "
+                      "default constructible and move assignable");
+        static_assert(NodeBytes >= 64, "nodes must be at least a cache line");
+
+      private:
+        static constexpr std::size_t leaf_slots = impl::b_plus_slots<T>(
+            NodeBytes - sizeof(impl::b_plus_leaf<T, 0>), sizeof(T));
+        static constexpr std::size_t inner_slots = impl::b_plus_slots<T>(
+            NodeBytes - sizeof(impl::b_plus_inner<T, 0>),
+            sizeof(T) + sizeof(void *));
+
+        using count_type = decltype(impl::b_plus_node_base::count);
+        static_assert(leaf_slots <= std::numeric_limits<count_type>::max() &&
+                          inner_slots <= std::numeric_limits<count_type>::max(),
+                      "NodeBytes is too large for a node's count to hold");
+
+        using node_base = impl::b_plus_node_base;
+        using leaf = impl::b_plus_leaf<T, leaf_slots>;
+        using inner = impl::b_plus_inner<T, inner_slots>;
+
+      public:
+        using value_type = T;
+        using key_compare = Compare;
+        using const_iterator = impl::b_plus_tree_iterator<leaf>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        /** the most elements a leaf holds, and keys an inner node holds */
+        static constexpr std::size_t leaf_capacity = leaf_slots - 1;
+        static constexpr std::size_t inner_capacity = inner_slots - 1;
+
+        b_plus_tree() = default;
+
+        explicit b_plus_tree(Compare const &compare) : compare(compare) {}
+
+        ~b_plus_tree() { clear(); }
+
+        /** O(n), bulk loads a copy of other's elements */
+        b_plus_tree(b_plus_tree const &other)
+              : b_plus_tree(
+                    from_sorted(other.begin(), other.end(), other.compare))
+        {
+        }
+
+        b_plus_tree(b_plus_tree &&other) noexcept
+              : root(std::exchange(other.root, nullptr)),
+                first_leaf(std::exchange(other.first_leaf, nullptr)),
+                last_leaf(std::exchange(other.last_leaf, nullptr)),
+                levels(std::exchange(other.levels, 0)),
+                _size(std::exchange(other._size, 0)),
+                compare(std::move(other.compare))
+        {
+        }
+
+        b_plus_tree &operator=(b_plus_tree const &other)
+        {
+            b_plus_tree tmp(other);
+            *this = std::move(tmp);
+            return *this;
+        }
+
+        b_plus_tree &operator=(b_plus_tree &&other) noexcept
+        {
+            clear();
+            root = std::exchange(other.root, nullptr);
+            first_leaf = std::exchange(other.first_leaf, nullptr);
+            last_leaf = std::exchange(other.last_leaf, nullptr);
+            levels = std::exchange(other.levels, 0);
+            _size = std::exchange(other._size, 0);
+            compare = std::move(other.compare);
+            return *this;
+        }
+
+        /*implicit*/ b_plus_tree(std::initializer_list<T> list)
+        {
+            for (auto const &e : list)
+            {
+                add(e);
+            }
+        }
+
+        /*
+         * builds the tree from a sorted range of unique elements in O(n),
+         * packing the leaves full rather than half full as adding them one
+         * by one would. Pass move iterators to move the elements in
+         */
+        template <typename Iter>
+        static b_plus_tree from_sorted(Iter first, Iter last,
+                                       Compare const &compare = Compare())
+        {
+            b_plus_tree bt(compare);
+            auto const n = static_cast<std::size_t>(std::distance(first, last));
+            if (n == 0)
+            {
+                return bt;
+            }
+
+            // the smallest key under each node of the level being built,
+            // which become the separators in the level above
+            std::vector<node_base *> nodes;
+            std::vector<T> mins;
+
+            // spread the elements evenly so no leaf is under half full
+            auto const leaves = (n + leaf_capacity - 1) / leaf_capacity;
+            leaf *prev = nullptr;
+            for (std::size_t l = 0; l != leaves; ++l)
+            {
+                auto const count = n / leaves + (l < n % leaves ? 1 : 0);
+                auto const lf = new_leaf();
+                for (std::size_t i = 0; i != count; ++i, ++first)
+                {
+                    lf->keys[i] = *first;
+                }
+                lf->count = static_cast<std::uint16_t>(count);
+                lf->prev = prev;
+                if (prev == nullptr)
+                {
+                    bt.first_leaf = lf;
+                }
+                else
+                {
+                    prev->next = lf;
+                }
+                prev = lf;
+                nodes.push_back(lf);
+                mins.push_back(lf->keys[0]);
+            }
+            bt.last_leaf = prev;
+
+            while (nodes.size() > 1)
+            {
+                std::vector<node_base *> parents;
+                std::vector<T> parent_mins;
+                auto const m = nodes.size();
+                auto const count = (m + inner_capacity) / (inner_capacity + 1);
+                std::size_t c = 0;
+                for (std::size_t p = 0; p != count; ++p)
+                {
+                    auto const children = m / count + (p < m % count ? 1 : 0);
+                    auto const in = new_inner();
+                    parent_mins.push_back(std::move(mins[c]));
+                    in->children[0] = nodes[c++];
+                    for (std::size_t i = 1; i != children; ++i, ++c)
+                    {
+                        in->keys[i - 1] = std::move(mins[c]);
+                        in->children[i] = nodes[c];
+                    }
+                    in->count = static_cast<std::uint16_t>(children - 1);
+                    parents.push_back(in);
+                }
+                nodes = std::move(parents);
+                mins = std::move(parent_mins);
+                ++bt.levels;
+            }
+
+            bt.root = nodes[0];
+            bt._size = n;
+            return bt;
+        }
+
+        friend bool operator==(b_plus_tree const &l, b_plus_tree const &r)
+        {
+            return l.size() == r.size() &&
+                   std::equal(l.begin(), l.end(), r.begin());
+        }
+
+        friend bool operator!=(b_plus_tree const &l, b_plus_tree const &r)
+        {
+            return !(l == r);
+        }
+
+        /** does nothing if an equivalent element is already in the tree */
+        void add(T t)
+        {
+            if (root == nullptr)
+            {
+                auto const lf = new_leaf();
+                lf->keys[0] = std::move(t);
+                lf->count = 1;
+                root = first_leaf = last_leaf = lf;
+                _size = 1;
+                return;
+            }
+
+            T separator{};
+            node_base *right = nullptr;
+            if (!add_to(root, levels, t, separator, right))
+            {
+                return;
+            }
+            ++_size;
+
+            if (right != nullptr)
+            {
+                // the root split, the tree grows a level at the top
+                auto const in = new_inner();
+                in->keys[0] = std::move(separator);
+                in->children[0] = root;
+                in->children[1] = right;
+                in->count = 1;
+                root = in;
+                ++levels;
+            }
+        }
+
+        void erase(T const &t) { erase_impl(t); }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        void erase(K const &k)
+        {
+            erase_impl(k);
+        }
+
+        bool contains(T const &t) const { return find(t) != end(); }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        bool contains(K const &k) const
+        {
+            return find(k) != end();
+        }
+
+        const_iterator find(T const &t) const { return find_impl(t); }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        const_iterator find(K const &k) const
+        {
+            return find_impl(k);
+        }
+
+        /** the first element not less than t, or end() if there is none */
+        const_iterator lower_bound(T const &t) const
+        {
+            return lower_bound_impl(t);
+        }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        const_iterator lower_bound(K const &k) const
+        {
+            return lower_bound_impl(k);
+        }
+
+        /** the first element greater than t, or end() if there is none */
+        const_iterator upper_bound(T const &t) const
+        {
+            return upper_bound_impl(t);
+        }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        const_iterator upper_bound(K const &k) const
+        {
+            return upper_bound_impl(k);
+        }
+
+        /** visits every element in order */
+        template <typename Callable>
+        void inorder_traverse(Callable const &visiter) const
+        {
+            for (auto lf = first_leaf; lf != nullptr; lf = lf->next)
+            {
+                for (std::size_t i = 0; i != lf->count; ++i)
+                {
+                    visiter(lf->keys[i]);
+                }
+            }
+        }
+
+        void clear() noexcept
+        {
+            if (root != nullptr)
+            {
+                destroy(root, levels);
+            }
+            root = nullptr;
+            first_leaf = last_leaf = nullptr;
+            levels = 0;
+            _size = 0;
+        }
+
+        bool is_empty() const { return root == nullptr; }
+
+        std::size_t size() const { return _size; }
+
+        /** the number of nodes on a path from the root to a leaf */
+        std::size_t height() const { return root == nullptr ? 0 : levels + 1; }
+
+        const_iterator begin() const { return {first_leaf, 0, &last_leaf}; }
+
+        const_iterator end() const { return {nullptr, 0, &last_leaf}; }
+
+        const_reverse_iterator rbegin() const
+        {
+            return const_reverse_iterator(end());
+        }
+
+        const_reverse_iterator rend() const
+        {
+            return const_reverse_iterator(begin());
+        }
+
+      private:
+        template <typename K>
+        static constexpr bool vector_search_v =
+            std::is_arithmetic_v<T> && std::is_same_v<K, T> &&
+            (std::is_same_v<Compare, std::less<T>> ||
+             std::is_same_v<Compare, std::less<>>);
+
+        /**
+         * what unused key slots hold, the largest T there is, so that it is
+         * never less than anything searched for
+         */
+        static constexpr T vacant_key()
+        {
+            if constexpr (std::numeric_limits<T>::has_infinity)
+            {
+                return std::numeric_limits<T>::infinity();
+            }
+            else
+            {
+                return std::numeric_limits<T>::max();
+            }
+        }
+
+        static leaf *new_leaf()
+        {
+            auto const lf = new leaf;
+            if constexpr (vector_search_v<T>)
+            {
+                lf->keys.fill(vacant_key());
+            }
+            return lf;
+        }
+
+        static inner *new_inner()
+        {
+            auto const in = new inner;
+            if constexpr (vector_search_v<T>)
+            {
+                in->keys.fill(vacant_key());
+            }
+            return in;
+        }
+
+        static leaf &as_leaf(node_base *n) { return *static_cast<leaf *>(n); }
+
+        static leaf const &as_leaf(node_base const *n)
+        {
+            return *static_cast<leaf const *>(n);
+        }
+
+        static inner &as_inner(node_base *n)
+        {
+            return *static_cast<inner *>(n);
+        }
+
+        static inner const &as_inner(node_base const *n)
+        {
+            return *static_cast<inner const *>(n);
+        }
+
+        // a counter as wide as the keys keeps the compares and the adds in
+        // the same vector lanes
+        using rank_counter = std::conditional_t<sizeof(T) <= 4, std::uint32_t,
+                                                std::uint64_t>;
+
+        /** the slot past the last key has to look unused again */
+        template <std::size_t Slots>
+        static void vacate(std::array<T, Slots> &keys, std::size_t i)
+        {
+            if constexpr (vector_search_v<T>)
+            {
+                keys[i] = vacant_key();
+            }
+        }
+
+        /** the number of the first count keys that are less than k */
+        template <std::size_t Slots, typename K>
+        std::size_t rank_less(std::array<T, Slots> const &keys,
+                              std::size_t count, K const &k) const
+        {
+            if constexpr (vector_search_v<K>)
+            {
+                // the slots past count hold the largest T, never less than k
+                rank_counter r = 0;
+                for (std::size_t i = 0; i != Slots; ++i)
+                {
+                    r += keys[i] < k;
+                }
+                return std::min<std::size_t>(r, count);
+            }
+            else
+            {
+                return static_cast<std::size_t>(
+                    std::lower_bound(keys.begin(), keys.begin() + count, k,
+                                     [this](T const &l, K const &r) {
+                                         return impl::compare_less(compare, l,
+                                                                   r);
+                                     }) -
+                    keys.begin());
+            }
+        }
+
+        /** the number of the first count keys that are not greater than k */
+        template <std::size_t Slots, typename K>
+        std::size_t rank_not_greater(std::array<T, Slots> const &keys,
+                                     std::size_t count, K const &k) const
+        {
+            if constexpr (vector_search_v<K>)
+            {
+                // unused slots do count when k is the largest T, but only
+                // after all of the real keys have
+                rank_counter r = 0;
+                for (std::size_t i = 0; i != Slots; ++i)
+                {
+                    r += keys[i] <= k;
+                }
+                return std::min<std::size_t>(r, count);
+            }
+            else
+            {
+                return static_cast<std::size_t>(
+                    std::upper_bound(keys.begin(), keys.begin() + count, k,
+                                     [this](K const &l, T const &r) {
+                                         return impl::compare_less(compare, l,
+                                                                   r);
+                                     }) -
+                    keys.begin());
+            }
+        }
+
+        /** the leaf k belongs in */
+        template <typename K> leaf const *leaf_for(K const &k) const
+        {
+            node_base const *n = root;
+            for (auto level = levels; level != 0; --level)
+            {
+                auto const &in = as_inner(n);
+                n = in.children[rank_not_greater(in.keys, in.count, k)];
+            }
+            return &as_leaf(n);
+        }
+
+        /** whether key i of lf, the first not less than k, is k */
+        template <typename K>
+        bool holds(leaf const &lf, std::size_t i, K const &k) const
+        {
+            return i != lf.count && !impl::compare_less(compare, k, lf.keys[i]);
+        }
+
+        /** key i of lf, or the first key of the next leaf if i is past it */
+        const_iterator at(leaf const *lf, std::size_t i) const
+        {
+            if (i == lf->count)
+            {
+                return {lf->next, 0, &last_leaf};
+            }
+            return {lf, i, &last_leaf};
+        }
+
+        template <typename K> const_iterator lower_bound_impl(K const &k) const
+        {
+            if (root == nullptr)
+            {
+                return end();
+            }
+            auto const lf = leaf_for(k);
+            return at(lf, rank_less(lf->keys, lf->count, k));
+        }
+
+        template <typename K> const_iterator upper_bound_impl(K const &k) const
+        {
+            if (root == nullptr)
+            {
+                return end();
+            }
+            auto const lf = leaf_for(k);
+            return at(lf, rank_not_greater(lf->keys, lf->count, k));
+        }
+
+        template <typename K> const_iterator find_impl(K const &k) const
+        {
+            if (root == nullptr)
+            {
+                return end();
+            }
+            auto const lf = leaf_for(k);
+            auto const i = rank_less(lf->keys, lf->count, k);
+            if (!holds(*lf, i, k))
+            {
+                return end();
+            }
+            return {lf, i, &last_leaf};
+        }
+
+        /** makes room at i by moving the keys from i up one slot */
+        template <std::size_t Slots>
+        static void open_gap(std::array<T, Slots> &keys, std::size_t count,
+                             std::size_t i)
+        {
+            std::move_backward(keys.begin() + i, keys.begin() + count,
+                               keys.begin() + count + 1);
+        }
+
+        /** closes the slot at i, the slot past the last key is vacated */
+        template <std::size_t Slots>
+        static void close_gap(std::array<T, Slots> &keys, std::size_t count,
+                              std::size_t i)
+        {
+            std::move(keys.begin() + i + 1, keys.begin() + count,
+                      keys.begin() + i);
+            vacate(keys, count - 1);
+        }
+
+        /*
+         * adds t under n, which is the root of a subtree level levels above
+         * the leaves. Returns false if it was already there. If n overflows
+         * it is split, right is set to its new right hand sibling and
+         * separator to the smallest key under it
+         */
+        bool add_to(node_base *n, std::size_t level, T &t, T &separator,
+                    node_base *&right)
+        {
+            if (level == 0)
+            {
+                auto &lf = as_leaf(n);
+                auto const i = rank_less(lf.keys, lf.count, t);
+                if (holds(lf, i, t))
+                {
+                    return false;
+                }
+                open_gap(lf.keys, lf.count, i);
+                lf.keys[i] = std::move(t);
+                if (++lf.count > leaf_capacity)
+                {
+                    auto const r = split(lf);
+                    separator = r->keys[0];
+                    right = r;
+                }
+                return true;
+            }
+
+            auto &in = as_inner(n);
+            auto const i = rank_not_greater(in.keys, in.count, t);
+            T child_separator{};
+            node_base *child_right = nullptr;
+            if (!add_to(in.children[i], level - 1, t, child_separator,
+                        child_right))
+            {
+                return false;
+            }
+
+            if (child_right != nullptr)
+            {
+                open_gap(in.keys, in.count, i);
+                std::move_backward(in.children.begin() + i + 1,
+                                   in.children.begin() + in.count + 1,
+                                   in.children.begin() + in.count + 2);
+                in.keys[i] = std::move(child_separator);
+                in.children[i + 1] = child_right;
+                if (++in.count > inner_capacity)
+                {
+                    right = split(in, separator);
+                }
+            }
+            return true;
+        }
+
+        /** moves the upper half of an overflowing leaf to a new one */
+        leaf *split(leaf &lf)
+        {
+            auto const r = new_leaf();
+            std::size_t const half = lf.count / 2;
+            for (std::size_t i = half; i != lf.count; ++i)
+            {
+                r->keys[i - half] = std::move(lf.keys[i]);
+                vacate(lf.keys, i);
+            }
+            r->count = static_cast<std::uint16_t>(lf.count - half);
+            lf.count = static_cast<std::uint16_t>(half);
+
+            r->prev = &lf;
+            r->next = lf.next;
+            (lf.next == nullptr ? last_leaf : lf.next->prev) = r;
+            lf.next = r;
+            return r;
+        }
+
+        /*
+         * moves the upper half of an overflowing inner node to a new one,
+         * the key in the middle moves up to the parent as separator
+         */
+        static inner *split(inner &in, T &separator)
+        {
+            auto const r = new_inner();
+            std::size_t const half = in.count / 2;
+            separator = std::move(in.keys[half]);
+            vacate(in.keys, half);
+            for (std::size_t i = half + 1; i != in.count; ++i)
+            {
+                r->keys[i - half - 1] = std::move(in.keys[i]);
+                vacate(in.keys, i);
+            }
+            std::copy(in.children.begin() + half + 1,
+                      in.children.begin() + in.count + 1, r->children.begin());
+            r->count = static_cast<std::uint16_t>(in.count - half - 1);
+            in.count = static_cast<std::uint16_t>(half);
+            return r;
+        }
+
+        template <typename K> void erase_impl(K const &k)
+        {
+            if (root == nullptr || !erase_from(root, levels, k))
+            {
+                return;
+            }
+            --_size;
+
+            if (levels == 0 && root->count == 0)
+            {
+                delete &as_leaf(root);
+                root = first_leaf = last_leaf = nullptr;
+            }
+            else if (levels != 0 && root->count == 0)
+            {
+                // the root is down to one child, the tree loses a level
+                auto const old = &as_inner(root);
+                root = old->children[0];
+                --levels;
+                delete old;
+            }
+        }
+
+        /** the fewest keys a node below the root can be left with */
+        static std::size_t min_count(std::size_t level)
+        {
+            return level == 0 ? leaf_capacity / 2 : inner_capacity / 2;
+        }
+
+        template <typename K>
+        bool erase_from(node_base *n, std::size_t level, K const &k)
+        {
+            if (level == 0)
+            {
+                auto &lf = as_leaf(n);
+                auto const i = rank_less(lf.keys, lf.count, k);
+                if (!holds(lf, i, k))
+                {
+                    return false;
+                }
+                close_gap(lf.keys, lf.count, i);
+                --lf.count;
+                return true;
+            }
+
+            auto &in = as_inner(n);
+            auto const i = rank_not_greater(in.keys, in.count, k);
+            if (!erase_from(in.children[i], level - 1, k))
+            {
+                return false;
+            }
+            if (in.children[i]->count < min_count(level - 1))
+            {
+                refill(in, i, level - 1);
+            }
+            return true;
+        }
+
+        /*
+         * child i of parent has dropped below half full. Takes a key from a
+         * sibling that can spare one, or failing that merges it with one
+         */
+        void refill(inner &parent, std::size_t i, std::size_t level)
+        {
+            auto const spare = [&](std::size_t c) {
+                return parent.children[c]->count > min_count(level);
+            };
+
+            if (i != 0 && spare(i - 1))
+            {
+                take_from_left(parent, i, level);
+            }
+            else if (i != parent.count && spare(i + 1))
+            {
+                take_from_right(parent, i, level);
+            }
+            else if (i != 0)
+            {
+                merge(parent, i - 1, level);
+            }
+            else
+            {
+                merge(parent, i, level);
+            }
+        }
+
+        void take_from_left(inner &parent, std::size_t i, std::size_t level)
+        {
+            auto &sep = parent.keys[i - 1];
+            if (level == 0)
+            {
+                auto &l = as_leaf(parent.children[i - 1]);
+                auto &c = as_leaf(parent.children[i]);
+                open_gap(c.keys, c.count, 0);
+                c.keys[0] = std::move(l.keys[l.count - 1]);
+                vacate(l.keys, l.count - 1);
+                ++c.count;
+                --l.count;
+                sep = c.keys[0];
+                return;
+            }
+
+            // the separator comes down and the left's last key goes up
+            auto &l = as_inner(parent.children[i - 1]);
+            auto &c = as_inner(parent.children[i]);
+            open_gap(c.keys, c.count, 0);
+            std::move_backward(c.children.begin(),
+                               c.children.begin() + c.count + 1,
+                               c.children.begin() + c.count + 2);
+            c.keys[0] = std::move(sep);
+            c.children[0] = l.children[l.count];
+            sep = std::move(l.keys[l.count - 1]);
+            vacate(l.keys, l.count - 1);
+            ++c.count;
+            --l.count;
+        }
+
+        void take_from_right(inner &parent, std::size_t i, std::size_t level)
+        {
+            auto &sep = parent.keys[i];
+            if (level == 0)
+            {
+                auto &c = as_leaf(parent.children[i]);
+                auto &r = as_leaf(parent.children[i + 1]);
+                c.keys[c.count] = std::move(r.keys[0]);
+                close_gap(r.keys, r.count, 0);
+                ++c.count;
+                --r.count;
+                sep = r.keys[0];
+                return;
+            }
+
+            auto &c = as_inner(parent.children[i]);
+            auto &r = as_inner(parent.children[i + 1]);
+            c.keys[c.count] = std::move(sep);
+            c.children[c.count + 1] = r.children[0];
+            sep = std::move(r.keys[0]);
+            close_gap(r.keys, r.count, 0);
+            std::move(r.children.begin() + 1,
+                      r.children.begin() + r.count + 1, r.children.begin());
+            ++c.count;
+            --r.count;
+        }
+
+        /** merges child i + 1 of parent into child i and deletes it */
+        void merge(inner &parent, std::size_t i, std::size_t level)
+        {
+            if (level == 0)
+            {
+                auto &l = as_leaf(parent.children[i]);
+                auto const r = &as_leaf(parent.children[i + 1]);
+                std::move(r->keys.begin(), r->keys.begin() + r->count,
+                          l.keys.begin() + l.count);
+                l.count = static_cast<std::uint16_t>(l.count + r->count);
+                l.next = r->next;
+                (r->next == nullptr ? last_leaf : r->next->prev) = &l;
+                delete r;
+            }
+            else
+            {
+                // the separator between them comes down between their keys
+                auto &l = as_inner(parent.children[i]);
+                auto const r = &as_inner(parent.children[i + 1]);
+                l.keys[l.count] = std::move(parent.keys[i]);
+                std::move(r->keys.begin(), r->keys.begin() + r->count,
+                          l.keys.begin() + l.count + 1);
+                std::copy(r->children.begin(),
+                          r->children.begin() + r->count + 1,
+                          l.children.begin() + l.count + 1);
+                l.count = static_cast<std::uint16_t>(l.count + r->count + 1);
+                delete r;
+            }
+
+            close_gap(parent.keys, parent.count, i);
+            std::move(parent.children.begin() + i + 2,
+                      parent.children.begin() + parent.count + 1,
+                      parent.children.begin() + i + 1);
+            --parent.count;
+        }
+
+        static void destroy(node_base *n, std::size_t level) noexcept
+        {
+            if (level == 0)
+            {
+                delete &as_leaf(n);
+                return;
+            }
+            auto const in = &as_inner(n);
+            for (std::size_t i = 0; i <= in->count; ++i)
+            {
+                destroy(in->children[i], level - 1);
+            }
+            delete in;
+        }
+
+        node_base *root = nullptr;
+        leaf *first_leaf = nullptr;
+        leaf *last_leaf = nullptr;
+        // the number of inner levels above the leaves
+        std::size_t levels = 0;
+        std::size_t _size = 0;
+        Compare compare;
+    };
+} // namespace csb
+
+#endif // CSB_B_PLUS_TREE_HPP
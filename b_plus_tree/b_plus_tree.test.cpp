@@ -0,0 +1,243 @@
+#include "b_plus_tree/b_plus_tree.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <iterator>
+#include <limits>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace csb::test
+{
+    namespace
+    {
+        // small nodes so that a few hundred elements make a deep tree and
+        // every split, borrow and merge gets exercised
+        using small_tree = b_plus_tree<int, std::less<int>, 64>;
+
+        template <typename Tree> auto values(Tree const &tree)
+        {
+            return std::vector<typename Tree::value_type>(tree.begin(),
+                                                          tree.end());
+        }
+    } // namespace
+
+    SCENARIO("b plus tree agrees with std::set")
+    {
+        GIVEN("a tree with small nodes under random adds and erases")
+        {
+            small_tree tree;
+            std::set<int> expected;
+
+            std::mt19937 gen(21);
+            std::uniform_int_distribution<> dis(0, 2000);
+            for (int round = 0; round != 20000; ++round)
+            {
+                auto const v = dis(gen);
+                // mostly adds to begin with and mostly erases at the end,
+                // so the tree grows a few levels and shrinks back again
+                if (dis(gen) < round / 10)
+                {
+                    tree.erase(v);
+                    expected.erase(v);
+                }
+                else
+                {
+                    tree.add(v);
+                    expected.insert(v);
+                }
+            }
+
+            THEN("it holds the same elements in the same order")
+            {
+                REQUIRE(tree.size() == expected.size());
+                REQUIRE(values(tree) ==
+                        std::vector<int>(expected.begin(), expected.end()));
+                REQUIRE(std::vector<int>(tree.rbegin(), tree.rend()) ==
+                        std::vector<int>(expected.rbegin(), expected.rend()));
+            }
+
+            THEN("searches agree with std::set")
+            {
+                for (int v = -1; v != 2002; ++v)
+                {
+                    REQUIRE(tree.contains(v) == (expected.count(v) == 1));
+
+                    auto const lb = tree.lower_bound(v);
+                    auto const elb = expected.lower_bound(v);
+                    REQUIRE((lb == tree.end()) == (elb == expected.end()));
+                    REQUIRE((lb == tree.end() || *lb == *elb));
+
+                    auto const ub = tree.upper_bound(v);
+                    auto const eub = expected.upper_bound(v);
+                    REQUIRE((ub == tree.end()) == (eub == expected.end()));
+                    REQUIRE((ub == tree.end() || *ub == *eub));
+                }
+            }
+
+            WHEN("everything is erased")
+            {
+                for (auto v : expected)
+                {
+                    tree.erase(v);
+                }
+
+                THEN("it is empty")
+                {
+                    REQUIRE(tree.is_empty());
+                    REQUIRE(tree.size() == 0);
+                    REQUIRE(tree.begin() == tree.end());
+                }
+            }
+        }
+
+        GIVEN("a tree of strings, which are binary searched")
+        {
+            b_plus_tree<std::string, std::less<>> tree;
+            std::set<std::string> expected;
+
+            std::mt19937 gen(3);
+            std::uniform_int_distribution<> dis(0, 999);
+            for (int round = 0; round != 5000; ++round)
+            {
+                auto const v = "key" + std::to_string(dis(gen));
+                if (round % 3 == 2)
+                {
+                    tree.erase(v);
+                    expected.erase(v);
+                }
+                else
+                {
+                    tree.add(v);
+                    expected.insert(v);
+                }
+            }
+
+            THEN("it holds the same elements in the same order")
+            {
+                REQUIRE(values(tree) == std::vector<std::string>(
+                                            expected.begin(), expected.end()));
+            }
+
+            THEN("it can be searched without building a string")
+            {
+                auto const first = *expected.begin();
+                REQUIRE(tree.contains(first.c_str()));
+                REQUIRE(*tree.find(first.c_str()) == first);
+                REQUIRE_FALSE(tree.contains("not a key"));
+            }
+        }
+    }
+
+    SCENARIO("b plus tree construction")
+    {
+        GIVEN("a tree bulk loaded from a sorted range")
+        {
+            std::vector<int> sorted;
+            for (int i = 0; i != 1000; ++i)
+            {
+                sorted.push_back(3 * i);
+            }
+            auto tree = small_tree::from_sorted(sorted.begin(), sorted.end());
+
+            THEN("it holds the range and is no taller than it needs to be")
+            {
+                REQUIRE(values(tree) == sorted);
+                REQUIRE(tree.size() == sorted.size());
+                REQUIRE(tree.height() <= 6);
+            }
+
+            THEN("it can be added to and erased from like any other")
+            {
+                std::set<int> expected(sorted.begin(), sorted.end());
+                for (int i = 0; i != 3000; ++i)
+                {
+                    if (i % 2 == 0)
+                    {
+                        tree.erase(i);
+                        expected.erase(i);
+                    }
+                    else
+                    {
+                        tree.add(i);
+                        expected.insert(i);
+                    }
+                }
+                REQUIRE(values(tree) ==
+                        std::vector<int>(expected.begin(), expected.end()));
+            }
+
+            WHEN("it is copied")
+            {
+                auto copy = tree;
+                copy.erase(0);
+
+                THEN("the copy is equal until it changes, and independent")
+                {
+                    REQUIRE(copy != tree);
+                    copy.add(0);
+                    REQUIRE(copy == tree);
+                    REQUIRE(values(tree) == sorted);
+                }
+            }
+        }
+
+        GIVEN("a tree holding the largest and smallest ints")
+        {
+            constexpr auto max = std::numeric_limits<int>::max();
+            constexpr auto min = std::numeric_limits<int>::min();
+            small_tree tree;
+            for (int i = 0; i != 100; ++i)
+            {
+                tree.add(max - i);
+                tree.add(min + i);
+            }
+
+            THEN("they are found even though they look like unused slots")
+            {
+                REQUIRE(tree.contains(max));
+                REQUIRE(tree.contains(min));
+                REQUIRE(*tree.lower_bound(max) == max);
+                REQUIRE(tree.upper_bound(max) == tree.end());
+                REQUIRE(*tree.rbegin() == max);
+                REQUIRE(*tree.begin() == min);
+                tree.erase(max);
+                REQUIRE_FALSE(tree.contains(max));
+                REQUIRE(*tree.rbegin() == max - 1);
+            }
+        }
+
+        GIVEN("a tree of doubles that does not hold infinity")
+        {
+            constexpr auto inf = std::numeric_limits<double>::infinity();
+            constexpr auto max = std::numeric_limits<double>::max();
+            b_plus_tree<double> tree{1, 2, 3};
+
+            THEN("unused slots, which hold the largest double, are not "
+                 "mistaken for elements less than infinity")
+            {
+                REQUIRE_FALSE(tree.contains(inf));
+                REQUIRE(tree.lower_bound(inf) == tree.end());
+                REQUIRE(tree.upper_bound(max) == tree.end());
+            }
+
+            WHEN("infinity and the largest double are added")
+            {
+                tree.add(inf);
+                tree.add(max);
+
+                THEN("both are found, in order")
+                {
+                    REQUIRE(tree.size() == 5);
+                    REQUIRE(tree.contains(inf));
+                    REQUIRE(tree.contains(max));
+                    REQUIRE(*tree.lower_bound(inf) == inf);
+                    REQUIRE(*std::prev(tree.end()) == inf);
+                    REQUIRE(*std::prev(tree.end(), 2) == max);
+                }
+            }
+        }
+    }
+} // namespace csb::test
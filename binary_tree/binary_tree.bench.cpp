@@ -0,0 +1,140 @@
+#include "binary_tree/binary_tree.hpp"
+#include "red_black_tree/red_black_tree.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace csb::bench
+{
+    namespace
+    {
+        constexpr int tree_size = 1000000;
+
+        std::vector<int> shuffled_keys(int n)
+        {
+            std::vector<int> keys(n);
+            std::iota(keys.begin(), keys.end(), 0);
+            std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+            return keys;
+        }
+
+        // the descent binary_tree_node used to do, kept here for comparison
+        template <typename Node>
+        bool recursive_add(Node &n, typename Node::pointer &v)
+        {
+            if (v->t < n.t)
+            {
+                if (n.left == nullptr)
+                {
+                    n.left = std::move(v);
+                    n.left->parent = &n;
+                    return true;
+                }
+                return recursive_add(*n.left, v);
+            }
+            else if (n.t < v->t)
+            {
+                if (n.right == nullptr)
+                {
+                    n.right = std::move(v);
+                    n.right->parent = &n;
+                    return true;
+                }
+                return recursive_add(*n.right, v);
+            }
+            return false;
+        }
+
+        template <typename Node>
+        Node const *recursive_find(Node const &n,
+                                   typename Node::value_type const &target)
+        {
+            if (n.t == target)
+            {
+                return &n;
+            }
+
+            auto const &next = n.t < target ? n.right : n.left;
+            return next == nullptr ? nullptr : recursive_find(*next, target);
+        }
+
+        template <typename Node> Node const &root_of(Node const &n)
+        {
+            auto r = &n;
+            while (r->parent != nullptr)
+            {
+                r = r->parent;
+            }
+            return *r;
+        }
+    } // namespace
+
+    TEST_CASE("recursive vs iterative descent", "[benchmark]")
+    {
+        auto const keys = shuffled_keys(tree_size);
+
+        using node_type = binary_tree<int>::node_type;
+        using node_pointer = node_type::pointer;
+
+        BENCHMARK_ADVANCED("recursive add, 1M keys")
+        (Catch::Benchmark::Chronometer meter)
+        {
+            std::vector<node_pointer> roots(meter.runs());
+            meter.measure([&](int run) {
+                auto &root = roots[run];
+                root = std::make_unique<node_type>(int(keys[0]));
+                for (auto k : keys)
+                {
+                    auto n = std::make_unique<node_type>(int(k));
+                    recursive_add(*root, n);
+                }
+            });
+        };
+
+        BENCHMARK_ADVANCED("iterative add, 1M keys")
+        (Catch::Benchmark::Chronometer meter)
+        {
+            std::vector<node_pointer> roots(meter.runs());
+            meter.measure([&](int run) {
+                auto &root = roots[run];
+                root = std::make_unique<node_type>(int(keys[0]));
+                for (auto k : keys)
+                {
+                    auto n = std::make_unique<node_type>(int(k));
+                    root->add(n);
+                }
+            });
+        };
+
+        red_black_tree<int> rb;
+        for (auto k : keys)
+        {
+            rb.add(k);
+        }
+        auto const &root = root_of(rb.begin().node());
+
+        BENCHMARK("recursive find, 1M keys")
+        {
+            std::size_t found = 0;
+            for (auto k : keys)
+            {
+                found += recursive_find(root, k) != nullptr;
+            }
+            return found;
+        };
+
+        BENCHMARK("iterative find, 1M keys")
+        {
+            std::size_t found = 0;
+            for (auto k : keys)
+            {
+                found += root.find(k) != nullptr;
+            }
+            return found;
+        };
+    }
+} // namespace csb::bench
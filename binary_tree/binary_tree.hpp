@@ -1,12 +1,21 @@
 #ifndef CSB_BINARY_TREE_HPP
 #define CSB_BINARY_TREE_HPP
 
+#include "node_handle.hpp"
+#include "order_statistic.hpp"
+#include "parallel.hpp"
+#include "threaded.hpp"
 #include "tree_utils.hpp"
 #include <core/type_traits.hpp>
 
+#include <algorithm>
+#include <functional>
+#include <iterator>
 #include <memory>
 #include <queue>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace csb
 {
@@ -16,21 +25,29 @@ namespace csb
         {
             using node_metadata_type = null_balancing_policy;
 
-            template <typename T>
-            using node_type = binary_tree_node<T, node_metadata_type>;
+            template <typename T,
+                      typename AllocationPolicy = heap_allocation_policy>
+            using node_type =
+                binary_tree_node<T, node_metadata_type, AllocationPolicy>;
 
-            template <typename T>
-            static std::unique_ptr<node_type<T>>
-            balance(std::unique_ptr<node_type<T>> root, node_type<T> *node)
+            template <typename Node>
+            static typename Node::pointer
+            balance(typename Node::pointer root, Node *node)
             {
                 // empty as there is no balancing a regular bst
                 (void)node;
-                return std::move(root);
+                return root;
             }
 
-            template <typename T>
-            static std::unique_ptr<node_type<T>>
-            erase_node(std::unique_ptr<node_type<T>> root, node_type<T> &target)
+            /*
+             * unlinks the node holding target's element and moves it into
+             * removed, which may not be target itself if target has two
+             * children
+             */
+            template <typename Node>
+            static typename Node::pointer
+            erase_node(typename Node::pointer root, Node &target,
+                       typename Node::pointer &removed)
             {
                 // regular bst deletion. no balancing needed
                 auto replacement = find_replacement(target);
@@ -39,45 +56,94 @@ namespace csb
                 if (replacement == nullptr)
                 {
                     // remove node
-                    root = detach(std::move(root), target);
+                    root = detach(std::move(root), target, removed);
                 }
                 // target has 1 child
                 else if (target.left == nullptr || target.right == nullptr)
                 {
                     auto &child = target.left ? target.left : target.right;
-                    root = detach(std::move(root), target, std::move(child));
+                    root = detach(std::move(root), target, removed,
+                                  std::move(child));
                 }
                 else
                 {
                     std::swap(target.t, replacement->t);
-                    root = erase_node(std::move(root), *replacement);
+                    root = erase_node(std::move(root), *replacement, removed);
                 }
 
-                return std::move(root);
+                return root;
+            }
+
+            /** the rank join balances by, there is none to keep */
+            template <typename Node> static std::size_t rank(Node const *root)
+            {
+                (void)root;
+                return 0;
+            }
+
+            /** the rank of child, given that of its parent node */
+            template <typename Node>
+            static std::size_t child_rank(Node const &node, std::size_t rank,
+                                          Node const *child)
+            {
+                (void)node;
+                (void)child;
+                return rank;
+            }
+
+            /*
+             * joins left and right under mid, where everything in left is
+             * less than mid and everything in right is greater
+             */
+            template <typename Node>
+            static ranked_tree<typename Node::pointer>
+            join(ranked_tree<typename Node::pointer> left,
+                 typename Node::pointer mid,
+                 ranked_tree<typename Node::pointer> right)
+            {
+                // no balance to keep so mid can just go on top
+                adopt(*mid, std::move(left.root), std::move(right.root));
+                return {std::move(mid), 0};
+            }
+
+            template <typename Node>
+            static void bulk_load_node(Node &node, std::size_t depth,
+                                       std::size_t height)
+            {
+                // nothing to record about a node
+                (void)node;
+                (void)depth;
+                (void)height;
             }
         };
 
     } // namespace impl
 
     template <typename T,
-              typename BalancingPolicy = impl::null_balancing_policy>
+              typename BalancingPolicy = impl::null_balancing_policy,
+              typename AllocationPolicy = impl::heap_allocation_policy,
+              typename Compare = std::less<T>>
     class binary_tree;
 
     namespace impl
     {
 
-        template <typename Node>
-        class binary_tree_iterator
-              : public std::iterator<std::forward_iterator_tag,
-                                     typename Node::value_type>
+        template <typename Node> class binary_tree_iterator
         {
           public:
+            using iterator_category = std::bidirectional_iterator_tag;
             using value_type = typename Node::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = value_type const *;
+            using reference = value_type const &;
 
             binary_tree_iterator &operator++()
             {
-
-                if (np->right != nullptr)
+                if constexpr (is_threaded_v<Node>)
+                {
+                    np = next_node(*np);
+                }
+                else if (np->right != nullptr)
                 {
                     // if you have a right subtree then next successor is the
                     // leftmost member of that tree
@@ -121,13 +187,17 @@ namespace csb
                 return cpy;
             }
 
-            binary_tree_iterator const &operator--()
+            binary_tree_iterator &operator--()
             {
 
-                // np == end the start got to rightmost of root
+                // np == end so the largest element is next
                 if (np == nullptr)
                 {
-                    np = rightmost(root);
+                    np = *last;
+                }
+                else if constexpr (is_threaded_v<Node>)
+                {
+                    np = prev_node(*np);
                 }
                 // if np has left child then nex inline is down that subtree
                 else if (np->left != nullptr)
@@ -169,20 +239,28 @@ namespace csb
                 return tmp;
             }
 
-            value_type const &operator*() const { return np->t; }
+            reference operator*() const { return np->t; }
+
+            pointer operator->() const { return &np->t; }
 
             Node const &node() const { return *np; }
 
           private:
-            explicit binary_tree_iterator(Node *p, Node *root)
-                  : np(p), root(root)
+            explicit binary_tree_iterator(Node *p, Node *const *last)
+                  : np(p), last(last)
             {
             }
 
             Node *np = nullptr;
-            Node *root = nullptr;
+            // the tree's cached rightmost node, so that --end() is O(1)
+            // and still right after the tree changes. It belongs to the
+            // tree object rather than its nodes, so moving the tree
+            // invalidates end() and rbegin() while other iterators stay
+            // valid, as swapping a std::set may invalidate its end()
+            Node *const *last = nullptr;
 
-            template <typename T, typename BP> friend class binary_tree;
+            template <typename T, typename BP, typename AP, typename C>
+            friend class csb::binary_tree;
 
             friend bool operator==(binary_tree_iterator const &l,
                                    binary_tree_iterator const &r)
@@ -197,31 +275,90 @@ namespace csb
             }
         };
 
+        /**
+         * the elements between two iterators into a tree, e.g. every key in
+         * [lo, hi) as returned by binary_tree::range
+         */
+        template <typename Iterator> class binary_tree_range
+        {
+          public:
+            binary_tree_range(Iterator first, Iterator last)
+                  : first(first), last(last)
+            {
+            }
+
+            Iterator begin() const { return first; }
+
+            Iterator end() const { return last; }
+
+            bool is_empty() const { return first == last; }
+
+          private:
+            Iterator first;
+            Iterator last;
+        };
+
     } // namespace impl
 
-    template <typename T, typename BalancingPolicy> class binary_tree
+    /*
+     * Compare works like it does for std::set. If it has an is_transparent
+     * member then find, contains and erase accept anything it can compare
+     * against a T, saving building a T just to look one up.
+     *
+     * Compare can also be a three way comparison (see three_way_compare)
+     * returning an int or an ordering rather than a bool, in which case
+     * searches only compare once per level of the tree
+     */
+    template <typename T, typename BalancingPolicy, typename AllocationPolicy,
+              typename Compare>
+    class binary_tree
     {
       public:
-        static_assert(is_totally_ordered_v<T>,
-                      "T must support operator < in order for binary tree to "
-                      "function properly");
+        static_assert(std::is_invocable_v<Compare const &, T const &,
+                                          T const &>,
+                      "Compare must be able to order two Ts in order for "
+                      "binary tree to function properly");
 
         using node_type =
-            binary_tree_node<T, typename BalancingPolicy::node_metadata_type>;
+            binary_tree_node<T, typename BalancingPolicy::node_metadata_type,
+                             AllocationPolicy>;
+        using node_pointer = typename node_type::pointer;
         using const_iterator = impl::binary_tree_iterator<node_type>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+        using const_range = impl::binary_tree_range<const_iterator>;
+        using node_handle = binary_tree_node_handle<node_type>;
+        using key_compare = Compare;
+        using balancing_policy = BalancingPolicy;
 
         binary_tree() = default;
-        ~binary_tree() = default;
 
+        explicit binary_tree(Compare const &compare) : compare(compare) {}
+
+        ~binary_tree() { clear(); }
+
+        /** O(n), copies the shape of other rather than re-adding to it */
         binary_tree(binary_tree const &other)
+              : root(clone_subtree(other.root.get())),
+                _size(other._size),
+                compare(other.compare)
         {
             static_assert(std::is_copy_constructible_v<T>);
-            other.breadth_first_traverse([this](T const &t) { add(t); });
+            // the clone's threads still point into other
+            thread_subtree(root.get());
+            reset_ends();
         }
 
+        /*
+         * takes other's nodes without touching them. Iterators into other
+         * then point into this tree, apart from end() and rbegin(), which
+         * still refer to other and must be fetched again from this tree
+         */
         binary_tree(binary_tree &&other) noexcept
               : root(std::move(other.root)),
-                _size(std::exchange(other._size, 0))
+                leftmost_node(std::exchange(other.leftmost_node, nullptr)),
+                rightmost_node(std::exchange(other.rightmost_node, nullptr)),
+                _size(std::exchange(other._size, 0)),
+                compare(std::move(other.compare))
         {
         }
 
@@ -235,8 +372,12 @@ namespace csb
 
         binary_tree &operator=(binary_tree &&other) noexcept
         {
+            clear();
             root = std::move(other.root);
+            leftmost_node = std::exchange(other.leftmost_node, nullptr);
+            rightmost_node = std::exchange(other.rightmost_node, nullptr);
             _size = std::exchange(other._size, 0);
+            compare = std::move(other.compare);
             return *this;
         }
 
@@ -255,6 +396,10 @@ namespace csb
             }
         }
 
+        /*
+         * sorts and dedupes the elements of container and then bulk loads
+         * them, see from_sorted
+         */
         template <
             template <typename, typename...> class Container, typename... Args,
             typename = std::enable_if_t<is_range_v<Container<T, Args...>>>,
@@ -263,28 +408,102 @@ namespace csb
             typename = std::enable_if_t<std::is_copy_constructible_v<T>>>
         explicit binary_tree(Container<T, Args...> &&container)
         {
+            std::vector<T> sorted;
             for (auto &e : container)
             {
                 if constexpr (std::is_rvalue_reference_v<decltype(container)>)
                 {
-                    add(std::move(e));
+                    sorted.push_back(std::move(e));
                 }
                 else
                 {
-                    add(e);
+                    sorted.push_back(e);
                 }
             }
+
+            auto const less = [this](T const &l, T const &r) {
+                return impl::compare_less(compare, l, r);
+            };
+
+            std::sort(sorted.begin(), sorted.end(), less);
+            auto last = std::unique(
+                sorted.begin(), sorted.end(), [&less](T const &l, T const &r) {
+                    return !less(l, r) && !less(r, l);
+                });
+
+            *this = from_sorted(std::make_move_iterator(sorted.begin()),
+                                std::make_move_iterator(last),
+                                compare);
         }
 
-        explicit binary_tree(std::unique_ptr<node_type> root)
+        /*
+         * builds a perfectly balanced tree from a sorted range of unique
+         * elements in O(n), without a single comparison or rebalance. Pass
+         * move iterators to move the elements in rather than copy them
+         */
+        template <typename Iter>
+        static binary_tree from_sorted(Iter first, Iter last,
+                                       Compare const &compare = Compare())
+        {
+            auto const n = static_cast<std::size_t>(std::distance(first, last));
+
+            binary_tree bt(compare);
+            bt.root = build_balanced(first, n, 0, balanced_height(n));
+            thread_subtree(bt.root.get());
+            bt._size = n;
+            bt.reset_ends();
+            return bt;
+        }
+
+        /*
+         * the parallel counterpart to the container constructor for rebuilding
+         * large trees. The elements are sorted and deduped and then bulk
+         * loaded as from_sorted does, with the sort and the top levels of the
+         * build each spread over up to threads threads. Equivalent elements
+         * keep the first of them in sorted order, which is not necessarily
+         * the first in elements
+         */
+        static binary_tree
+        from_unsorted(std::vector<T> elements,
+                      std::size_t threads = impl::default_thread_count(),
+                      Compare const &compare = Compare())
+        {
+            auto const less = [&compare](T const &l, T const &r) {
+                return impl::compare_less(compare, l, r);
+            };
+
+            impl::parallel_sort(elements.begin(), elements.end(), less,
+                                threads);
+            auto const last = std::unique(
+                elements.begin(), elements.end(),
+                [&less](T const &l, T const &r) {
+                    return !less(l, r) && !less(r, l);
+                });
+            auto const n =
+                static_cast<std::size_t>(last - elements.begin());
+
+            binary_tree bt(compare);
+            bt.root = build_balanced_parallel(
+                std::make_move_iterator(elements.begin()), n, 0,
+                balanced_height(n), threads);
+            thread_subtree(bt.root.get());
+            bt._size = n;
+            bt.reset_ends();
+            return bt;
+        }
+
+        explicit binary_tree(node_pointer root)
               : root(std::move(root)), _size(0)
         {
+            thread_subtree(this->root.get());
+            reset_ends();
             _size = std::distance(begin(), end());
+            refresh_subtree(this->root.get());
         }
 
         friend bool operator==(binary_tree const &l, binary_tree const &r)
         {
-            return l._size == r._size &&
+            return l.size() == r.size() &&
                    std::equal(l.begin(), l.end(), r.begin());
         }
 
@@ -295,51 +514,341 @@ namespace csb
 
         void add(T t)
         {
-            auto n = std::make_unique<node_type>(std::move(t));
+            node_pointer n =
+                AllocationPolicy::template make_node<node_type>(std::move(t));
+            link_node(n);
+        }
+
+        /**
+         * add t just before hint, skipping the descent from the root if that
+         * is where t belongs. For a stream of increasing elements pass end().
+         * A wrong hint costs two comparisons before falling back to a normal
+         * add. Returns an iterator to t, or to the element equivalent to t
+         * already in the tree
+         */
+        const_iterator add(const_iterator hint, T t)
+        {
+            node_pointer n =
+                AllocationPolicy::template make_node<node_type>(std::move(t));
             auto tmp = n.get();
 
-            if (root == nullptr)
-            {
-                root = BalancingPolicy::balance(std::move(n), tmp);
-                _size = 1;
-            }
-            else
+            // decrementing begin() gives end(), i.e. no predecessor
+            auto before = hint;
+            --before;
+            auto const next = hint.np;
+            auto const prev = before.np;
+
+            if (root == nullptr ||
+                (prev != nullptr &&
+                 !impl::compare_less(compare, prev->t, tmp->t)) ||
+                (next != nullptr &&
+                 !impl::compare_less(compare, tmp->t, next->t)))
             {
-                if (root->add(n))
+                // bad hint (or t is already in the tree)
+                if (!link_node(n))
                 {
-                    root = BalancingPolicy::balance(std::move(root), tmp);
-                    ++_size;
+                    return find(tmp->t);
                 }
+                return const_iterator(tmp, &rightmost_node);
             }
+
+            // t goes between prev and next. One of them always has a free
+            // link on the side facing the other
+            auto parent =
+                next != nullptr && next->left == nullptr ? next : prev;
+            auto &link = parent == next ? parent->left : parent->right;
+            link = std::move(n);
+            link->parent = parent;
+            parent->refresh_path();
+            note_added(*tmp);
+
+            root = BalancingPolicy::balance(std::move(root), tmp);
+            ++_size;
+            return const_iterator(tmp, &rightmost_node);
         }
 
-        void erase(T const &t)
+        /**
+         * relink the node owned by handle into this tree. If an equivalent
+         * element is already here the handle keeps the node. Returns where
+         * the element is and whether it was inserted
+         */
+        std::pair<const_iterator, bool> insert(node_handle &&handle)
         {
-            if (root != nullptr)
+            if (handle.is_empty())
             {
-                auto target = root->find(t);
+                return {end(), false};
+            }
 
-                if (target != nullptr)
-                {
-                    --_size;
-                    root =
-                        BalancingPolicy::erase_node(std::move(root), *target);
-                }
+            auto tmp = handle.node.get();
+            if (!link_node(handle.node))
+            {
+                return {find(tmp->t), false};
             }
+            return {const_iterator(tmp, &rightmost_node), true};
+        }
+
+        /**
+         * unlink the element equivalent to t and hand its node back rather
+         * than freeing it. The handle is empty if there is no such element
+         */
+        node_handle extract(T const &t) { return extract_impl(t); }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        node_handle extract(K const &k)
+        {
+            return extract_impl(k);
+        }
+
+        /**
+         * move every element not less than k into the tree returned, leaving
+         * the elements less than k in this one. Cuts the path down to k out
+         * of the tree and joins the pieces back into two trees, O(log n)
+         * on a balanced tree. Threaded trees also walk down to the ends of
+         * each piece to rethread it, O(log^2 n). Without subtree sizes (see
+         * order_statistic_policy) the size of each half is found by counting
+         * the smaller one, O(min(m, n - m)) for halves of size m and n - m
+         */
+        binary_tree split(T const &t) { return split_impl(t); }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        binary_tree split(K const &k)
+        {
+            return split_impl(k);
+        }
+
+        /**
+         * concatenate two trees where every element of left is less than
+         * every element of right. O(log n) on a balanced tree, the smallest
+         * element of right is taken out and used to join the two together
+         */
+        static binary_tree join(binary_tree &&left, binary_tree &&right)
+        {
+            if (right.root == nullptr)
+            {
+                return std::move(left);
+            }
+            if (left.root == nullptr)
+            {
+                return std::move(right);
+            }
+
+            auto const size = left._size + right._size;
+
+            binary_tree joined(left.compare);
+            joined.root = join_nodes(rank_of(std::move(left.root)),
+                                     rank_of(std::move(right.root)))
+                              .root;
+            joined._size = size;
+            joined.reset_ends();
+
+            left.clear();
+            right.clear();
+            return joined;
+        }
+
+        /*
+         * The set operations below consume both trees, relinking their nodes
+         * into the result rather than allocating new ones. Each splits b by
+         * the root of a, recurses on both halves and joins the results.
+         * Splits and joins take time in the difference of the ranks of the
+         * pieces, so for trees of size m <= n that is O(m log(n/m + 1)).
+         * Where an element is in both trees the node from a is the one kept.
+         * The recursion counts the elements found in both trees, which gives
+         * the size of the result without counting it
+         */
+
+        /** every element in either a or b */
+        static binary_tree set_union(binary_tree &&a, binary_tree &&b)
+        {
+            auto const size = a.size() + b.size();
+            binary_tree result(a.compare);
+            std::size_t matches = 0;
+            result.root = union_nodes(rank_of(std::move(a.root)),
+                                      rank_of(std::move(b.root)), a.compare,
+                                      matches)
+                              .root;
+            result._size = size - matches;
+            result.reset_ends();
+            a.clear();
+            b.clear();
+            return result;
+        }
+
+        /** every element in both a and b */
+        static binary_tree set_intersection(binary_tree &&a, binary_tree &&b)
+        {
+            binary_tree result(a.compare);
+            std::size_t matches = 0;
+            result.root = intersection_nodes(rank_of(std::move(a.root)),
+                                             rank_of(std::move(b.root)),
+                                             a.compare, matches)
+                              .root;
+            result._size = matches;
+            result.reset_ends();
+            a.clear();
+            b.clear();
+            return result;
+        }
+
+        /** every element in a but not in b */
+        static binary_tree set_difference(binary_tree &&a, binary_tree &&b)
+        {
+            auto const size = a.size();
+            binary_tree result(a.compare);
+            std::size_t matches = 0;
+            result.root = difference_nodes(rank_of(std::move(a.root)),
+                                           rank_of(std::move(b.root)),
+                                           a.compare, matches)
+                              .root;
+            result._size = size - matches;
+            result.reset_ends();
+            a.clear();
+            b.clear();
+            return result;
+        }
+
+        void erase(T const &t) { erase_impl(t); }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        void erase(K const &k)
+        {
+            erase_impl(k);
         }
 
         bool contains(T const &t) const { return find(t) != end(); }
 
-        const_iterator find(T const &t) const
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        bool contains(K const &k) const
         {
-            if (root == nullptr)
+            return find(k) != end();
+        }
+
+        const_iterator find(T const &t) const { return find_impl(t); }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        const_iterator find(K const &k) const
+        {
+            return find_impl(k);
+        }
+
+        /** the first element not less than t, or end() if there is none */
+        const_iterator lower_bound(T const &t) const
+        {
+            return lower_bound_impl(t);
+        }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        const_iterator lower_bound(K const &k) const
+        {
+            return lower_bound_impl(k);
+        }
+
+        /** the first element greater than t, or end() if there is none */
+        const_iterator upper_bound(T const &t) const
+        {
+            return upper_bound_impl(t);
+        }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        const_iterator upper_bound(K const &k) const
+        {
+            return upper_bound_impl(k);
+        }
+
+        /** the elements equivalent to t, at most one as keys are unique */
+        std::pair<const_iterator, const_iterator>
+        equal_range(T const &t) const
+        {
+            return {lower_bound_impl(t), upper_bound_impl(t)};
+        }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        std::pair<const_iterator, const_iterator> equal_range(K const &k) const
+        {
+            return {lower_bound_impl(k), upper_bound_impl(k)};
+        }
+
+        /**
+         * every element in [lo, hi). Both ends are found up front in
+         * O(log n) so iterating the range never looks at anything past hi
+         */
+        const_range range(T const &lo, T const &hi) const
+        {
+            return range_impl(lo, hi);
+        }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        const_range range(K const &lo, K const &hi) const
+        {
+            return range_impl(lo, hi);
+        }
+
+        key_compare key_comp() const { return compare; }
+
+        /**
+         * the element at position k in sorted order, or end() if k is out of
+         * range. O(log n), needs an impl::order_statistic_policy
+         */
+        const_iterator nth(std::size_t k) const
+        {
+            static_assert(impl::is_order_statistic_v<BalancingPolicy>,
+                          "nth requires an order_statistic_policy");
+
+            auto n = root.get();
+            while (n != nullptr)
             {
-                return end();
+                auto const left_size = impl::subtree_size(n->left.get());
+                if (k < left_size)
+                {
+                    n = n->left.get();
+                }
+                else if (k == left_size)
+                {
+                    break;
+                }
+                else
+                {
+                    k -= left_size + 1;
+                    n = n->right.get();
+                }
             }
-            else
+            return const_iterator(n, &rightmost_node);
+        }
+
+        /**
+         * the number of elements less than k, i.e. the position k is or would
+         * be at in sorted order. O(log n), needs an
+         * impl::order_statistic_policy
+         */
+        template <typename K> std::size_t rank(K const &k) const
+        {
+            static_assert(impl::is_order_statistic_v<BalancingPolicy>,
+                          "rank requires an order_statistic_policy");
+
+            std::size_t r = 0;
+            auto n = root.get();
+            while (n != nullptr)
             {
-                return impl::binary_tree_iterator(root->find(t), root.get());
+                if (impl::compare_less(compare, n->t, k))
+                {
+                    r += impl::subtree_size(n->left.get()) + 1;
+                    n = n->right.get();
+                }
+                else
+                {
+                    n = n->left.get();
+                }
             }
+            return r;
         }
 
         template <typename Callable>
@@ -351,6 +860,15 @@ namespace csb
             }
         }
 
+        template <typename Callable>
+        void reverse_inorder_traverse(Callable const &visiter) const
+        {
+            if (root != nullptr)
+            {
+                root->reverse_inorder_traverse(visiter);
+            }
+        }
+
         template <typename Callable>
         void breadth_first_traverse(Callable const &visiter) const
         {
@@ -386,23 +904,686 @@ namespace csb
             }
         }
 
-        bool is_empty() const { return _size == 0; }
+        /*
+         * calls visiter on every element from up to threads threads at
+         * once, in no particular order, so visiter must be safe to call
+         * concurrently. The tree is cut into a few times more subtrees than
+         * there are threads and each thread takes the next subtree whenever
+         * it finishes one. The tree must not change until it returns
+         */
+        template <typename Callable>
+        void parallel_for_each(
+            Callable const &visiter,
+            std::size_t threads = impl::default_thread_count()) const
+        {
+            auto const items = impl::split_work(root.get(), 4 * threads);
+            impl::run_parallel(items.size(), threads, [&](std::size_t i) {
+                items[i].visit(visiter);
+            });
+        }
+
+        /*
+         * the ordered counterpart to parallel_for_each. Each subtree is
+         * folded in key order from identity, acc = fold(std::move(acc), e),
+         * and the results are then combined in key order on the calling
+         * thread. combine only has to be associative, not commutative, so
+         * the result is the same as a sequential fold over begin() to end()
+         */
+        template <typename R, typename Fold, typename Combine>
+        R parallel_reduce(
+            R const &identity, Fold const &fold, Combine const &combine,
+            std::size_t threads = impl::default_thread_count()) const
+        {
+            auto const items = impl::split_work(root.get(), 4 * threads);
+            std::vector<impl::padded<R>> partials(items.size(),
+                                                  impl::padded<R>{identity});
+            impl::run_parallel(items.size(), threads, [&](std::size_t i) {
+                auto &acc = partials[i].value;
+                items[i].visit([&acc, &fold](T const &e) {
+                    acc = fold(std::move(acc), e);
+                });
+            });
+
+            auto result = identity;
+            for (auto &p : partials)
+            {
+                result = combine(std::move(result), std::move(p.value));
+            }
+            return result;
+        }
+
+        /*
+         * tear the tree down without recursing. Letting the nodes destroy
+         * each other would use a stack frame per level
+         */
+        void clear() noexcept
+        {
+            auto n = std::move(root);
+            while (n != nullptr)
+            {
+                if (n->left != nullptr)
+                {
+                    // rotate the left child up so that n never has one
+                    auto l = std::move(n->left);
+                    n->left = std::move(l->right);
+                    l->right = std::move(n);
+                    n = std::move(l);
+                }
+                else
+                {
+                    n = std::move(n->right);
+                }
+            }
+            leftmost_node = nullptr;
+            rightmost_node = nullptr;
+            _size = 0;
+        }
+
+        bool is_empty() const { return root == nullptr; }
 
         std::size_t size() const { return _size; }
 
+        /** the smallest element, O(1). The tree must not be empty */
+        T const &min() const { return leftmost_node->t; }
+
+        /** the largest element, O(1). The tree must not be empty */
+        T const &max() const { return rightmost_node->t; }
+
+        /**
+         * remove and return the smallest element. The tree must not be
+         * empty. Finding the next smallest is amortised O(1), so this costs
+         * no more than the rebalancing, which is amortised O(1) for a red
+         * black tree
+         */
+        T pop_min()
+        {
+            auto const next = std::next(begin()).np;
+
+            node_pointer removed;
+            --_size;
+            root = BalancingPolicy::erase_node(std::move(root),
+                                               *leftmost_node, removed);
+
+            // the smallest node never has a left child, so it is always the
+            // node removed and the nodes around it keep their elements
+            leftmost_node = next;
+            if (next == nullptr)
+            {
+                rightmost_node = nullptr;
+            }
+            return std::move(removed->t);
+        }
+
         const_iterator begin() const
         {
-            return const_iterator(leftmost(root.get()), root.get());
+            return const_iterator(leftmost_node, &rightmost_node);
         }
 
         const_iterator end() const
         {
-            return const_iterator(nullptr, root.get());
+            return const_iterator(nullptr, &rightmost_node);
+        }
+
+        /** iterates from the largest element down, O(1) like end() */
+        const_reverse_iterator rbegin() const
+        {
+            return const_reverse_iterator(end());
+        }
+
+        const_reverse_iterator rend() const
+        {
+            return const_reverse_iterator(begin());
         }
 
       private:
-        std::unique_ptr<node_type> root = nullptr;
+        /*
+         * links n into the tree and rebalances. If an equivalent element is
+         * already in the tree n is left holding the node
+         */
+        bool link_node(node_pointer &n)
+        {
+            auto tmp = n.get();
+
+            if (root == nullptr)
+            {
+                root = BalancingPolicy::balance(std::move(n), tmp);
+                leftmost_node = rightmost_node = tmp;
+                _size = 1;
+                return true;
+            }
+
+            if (root->add(n, compare))
+            {
+                note_added(*tmp);
+                root = BalancingPolicy::balance(std::move(root), tmp);
+                ++_size;
+                return true;
+            }
+            return false;
+        }
+
+        template <typename K> void erase_impl(K const &k)
+        {
+            if (root != nullptr)
+            {
+                auto target = root->find(k, compare);
+
+                if (target != nullptr)
+                {
+                    node_pointer removed;
+                    --_size;
+                    root = BalancingPolicy::erase_node(std::move(root),
+                                                       *target, removed);
+                    note_removed(*removed);
+                }
+            }
+        }
+
+        template <typename K> node_handle extract_impl(K const &k)
+        {
+            auto target = root == nullptr ? nullptr : root->find(k, compare);
+            if (target == nullptr)
+            {
+                return node_handle();
+            }
+
+            // the policy may swap the element into another node before
+            // unlinking it, removed is whichever node ends up holding it
+            node_pointer removed;
+            --_size;
+            root = BalancingPolicy::erase_node(std::move(root), *target,
+                                               removed);
+            note_removed(*removed);
+            removed->unlink();
+            return node_handle(std::move(removed));
+        }
+
+        using ranked = ranked_tree<node_pointer>;
+
+        /** the whole tree under root with its rank, see ranked_tree */
+        static ranked rank_of(node_pointer root)
+        {
+            auto const rank = BalancingPolicy::rank(root.get());
+            return {std::move(root), rank};
+        }
+
+        template <typename K> binary_tree split_impl(K const &k)
+        {
+            auto const total = _size;
+            auto [lower, match, upper] =
+                split_nodes(rank_of(std::move(root)), k, compare);
+            if (match != nullptr)
+            {
+                upper =
+                    join_nodes(ranked(), std::move(match), std::move(upper));
+            }
+
+            root = std::move(lower.root);
+            reset_ends();
+
+            binary_tree split_off(compare);
+            split_off.root = std::move(upper.root);
+            split_off.reset_ends();
+
+            _size = lower_size(split_off, total);
+            split_off._size = total - _size;
+            return split_off;
+        }
+
+        /*
+         * the size of this tree once upper has been split off a tree of
+         * size total. Trees that keep subtree sizes know it already, the
+         * rest step through both halves at once and stop at the end of the
+         * smaller one
+         */
+        std::size_t lower_size(binary_tree const &upper,
+                               std::size_t total) const
+        {
+            if constexpr (impl::is_order_statistic_v<BalancingPolicy>)
+            {
+                return impl::subtree_size(root.get());
+            }
+            else
+            {
+                auto l = begin();
+                auto u = upper.begin();
+                std::size_t counted = 0;
+                for (; l != end() && u != upper.end(); ++l, ++u)
+                {
+                    ++counted;
+                }
+                return l == end() ? counted : total - counted;
+            }
+        }
+
+        struct split_result
+        {
+            ranked lower;
+            node_pointer match;
+            ranked upper;
+        };
+
+        /*
+         * splits tree into the elements less than k, the node equivalent to
+         * k if there is one and the elements greater than k. Each subtree
+         * cut off the path to k has its rank worked out from its parent's,
+         * so every join costs the difference in the ranks of the trees it
+         * joins. Those add up along the path, O(log n) in all
+         */
+        template <typename K>
+        static split_result split_nodes(ranked tree, K const &k,
+                                        Compare const &compare)
+        {
+            // cut the path to k out of the tree, keeping hold of the
+            // subtrees hanging off the side of it
+            struct cut
+            {
+                node_pointer node;
+                ranked side;
+                bool less;
+            };
+            std::vector<cut> path;
+
+            split_result result;
+            auto n = std::move(tree.root);
+            auto rank = tree.rank;
+            while (n != nullptr)
+            {
+                auto const less = impl::compare_less(compare, n->t, k);
+                if (!less && !impl::compare_less(compare, k, n->t))
+                {
+                    // found k, its children start off the two halves
+                    expose(n, rank, result.lower, result.upper);
+                    result.match = std::move(n);
+                    break;
+                }
+
+                auto next = std::move(less ? n->right : n->left);
+                auto side = std::move(less ? n->left : n->right);
+                auto const next_rank =
+                    BalancingPolicy::child_rank(*n, rank, next.get());
+                auto const side_rank =
+                    BalancingPolicy::child_rank(*n, rank, side.get());
+                path.push_back({std::move(n), {std::move(side), side_rank},
+                                less});
+                n = std::move(next);
+                rank = next_rank;
+            }
+
+            // then join the pieces back up from the bottom, each path node
+            // joining its side subtree to whichever half it belongs in
+            for (auto it = path.rbegin(); it != path.rend(); ++it)
+            {
+                it->node->unlink();
+                if (it->side.root != nullptr)
+                {
+                    it->side.root->parent = nullptr;
+                    cut_threads(it->side.root.get());
+                }
+
+                if (it->less)
+                {
+                    result.lower =
+                        join_nodes(std::move(it->side), std::move(it->node),
+                                   std::move(result.lower));
+                }
+                else
+                {
+                    result.upper =
+                        join_nodes(std::move(result.upper),
+                                   std::move(it->node), std::move(it->side));
+                }
+            }
+            return result;
+        }
+
+        /*
+         * unlink the root of a tree of the given rank from the subtrees
+         * either side of it
+         */
+        static void expose(node_pointer &n, std::size_t rank, ranked &left,
+                           ranked &right)
+        {
+            left.rank = BalancingPolicy::child_rank(*n, rank, n->left.get());
+            right.rank = BalancingPolicy::child_rank(*n, rank, n->right.get());
+            left.root = std::move(n->left);
+            right.root = std::move(n->right);
+            if (left.root != nullptr)
+            {
+                left.root->parent = nullptr;
+                cut_threads(left.root.get());
+            }
+            if (right.root != nullptr)
+            {
+                right.root->parent = nullptr;
+                cut_threads(right.root.get());
+            }
+            n->unlink();
+        }
+
+        static ranked join_nodes(ranked left, node_pointer mid, ranked right)
+        {
+            return BalancingPolicy::template join<node_type>(
+                std::move(left), std::move(mid), std::move(right));
+        }
+
+        /** join without a middle node, borrowing the smallest of right */
+        static ranked join_nodes(ranked left, ranked right)
+        {
+            if (left.root == nullptr)
+            {
+                return right;
+            }
+            if (right.root == nullptr)
+            {
+                return left;
+            }
+
+            node_pointer mid;
+            auto rest = BalancingPolicy::erase_node(
+                std::move(right.root), *leftmost(right.root.get()), mid);
+            mid->unlink();
+
+            // erasing can shrink right's rank, but measuring it again costs
+            // no more than finding its smallest node did
+            return join_nodes(std::move(left), std::move(mid),
+                              rank_of(std::move(rest)));
+        }
+
+        static ranked union_nodes(ranked a, ranked b, Compare const &compare,
+                                  std::size_t &matches)
+        {
+            if (a.root == nullptr)
+            {
+                return b;
+            }
+            if (b.root == nullptr)
+            {
+                return a;
+            }
+
+            ranked a_left, a_right;
+            expose(a.root, a.rank, a_left, a_right);
+            auto [b_left, duplicate, b_right] =
+                split_nodes(std::move(b), a.root->t, compare);
+
+            if (duplicate != nullptr)
+            {
+                ++matches;
+            }
+
+            auto left = union_nodes(std::move(a_left), std::move(b_left),
+                                    compare, matches);
+            auto right = union_nodes(std::move(a_right), std::move(b_right),
+                                     compare, matches);
+            return join_nodes(std::move(left), std::move(a.root),
+                              std::move(right));
+        }
+
+        static ranked intersection_nodes(ranked a, ranked b,
+                                         Compare const &compare,
+                                         std::size_t &matches)
+        {
+            if (a.root == nullptr || b.root == nullptr)
+            {
+                return ranked();
+            }
+
+            ranked a_left, a_right;
+            expose(a.root, a.rank, a_left, a_right);
+            auto [b_left, match, b_right] =
+                split_nodes(std::move(b), a.root->t, compare);
+
+            auto left = intersection_nodes(std::move(a_left),
+                                           std::move(b_left), compare, matches);
+            auto right = intersection_nodes(
+                std::move(a_right), std::move(b_right), compare, matches);
+            if (match != nullptr)
+            {
+                ++matches;
+                return join_nodes(std::move(left), std::move(a.root),
+                                  std::move(right));
+            }
+            return join_nodes(std::move(left), std::move(right));
+        }
+
+        static ranked difference_nodes(ranked a, ranked b,
+                                       Compare const &compare,
+                                       std::size_t &matches)
+        {
+            if (a.root == nullptr || b.root == nullptr)
+            {
+                return a;
+            }
+
+            ranked a_left, a_right;
+            expose(a.root, a.rank, a_left, a_right);
+            auto [b_left, match, b_right] =
+                split_nodes(std::move(b), a.root->t, compare);
+
+            auto left = difference_nodes(std::move(a_left), std::move(b_left),
+                                         compare, matches);
+            auto right = difference_nodes(std::move(a_right),
+                                          std::move(b_right), compare, matches);
+            if (match != nullptr)
+            {
+                ++matches;
+                return join_nodes(std::move(left), std::move(right));
+            }
+            return join_nodes(std::move(left), std::move(a.root),
+                              std::move(right));
+        }
+
+        /*
+         * The smallest and largest nodes are cached so that begin(), --end(),
+         * min() and max() are O(1). Rotations never change which node is
+         * smallest or largest, only adding and removing nodes do
+         */
+        void reset_ends()
+        {
+            leftmost_node = leftmost(root.get());
+            rightmost_node = rightmost(root.get());
+        }
+
+        /** call once n is linked, before rebalancing moves it */
+        void note_added(node_type &n)
+        {
+            if (n.parent == leftmost_node && leftmost_node->left.get() == &n)
+            {
+                leftmost_node = &n;
+            }
+            if (n.parent == rightmost_node &&
+                rightmost_node->right.get() == &n)
+            {
+                rightmost_node = &n;
+            }
+        }
+
+        /** call once removed is unlinked, it may not be the node erased */
+        void note_removed(node_type const &removed)
+        {
+            if (&removed == leftmost_node)
+            {
+                leftmost_node = leftmost(root.get());
+            }
+            if (&removed == rightmost_node)
+            {
+                rightmost_node = rightmost(root.get());
+            }
+        }
+
+        template <typename K> const_iterator find_impl(K const &k) const
+        {
+            if (root == nullptr)
+            {
+                return end();
+            }
+            else
+            {
+                return const_iterator(root->find(k, compare),
+                                      &rightmost_node);
+            }
+        }
+
+        /*
+         * The bounds descend like find but carry on to a leaf, remembering
+         * the last node they went left at. That node is the smallest element
+         * on the right side of the bound
+         */
+        template <typename K> const_iterator lower_bound_impl(K const &k) const
+        {
+            node_type *bound = nullptr;
+            auto n = root.get();
+            while (n != nullptr)
+            {
+                auto const go_right = impl::compare_less(compare, n->t, k);
+                bound = go_right ? bound : n;
+                auto &next = go_right ? n->right : n->left;
+                n = next.get();
+            }
+            return const_iterator(bound, &rightmost_node);
+        }
+
+        template <typename K> const_iterator upper_bound_impl(K const &k) const
+        {
+            node_type *bound = nullptr;
+            auto n = root.get();
+            while (n != nullptr)
+            {
+                auto const go_left = impl::compare_less(compare, k, n->t);
+                bound = go_left ? n : bound;
+                auto &next = go_left ? n->left : n->right;
+                n = next.get();
+            }
+            return const_iterator(bound, &rightmost_node);
+        }
+
+        template <typename K>
+        const_range range_impl(K const &lo, K const &hi) const
+        {
+            auto const first = lower_bound_impl(lo);
+
+            // nothing in [lo, hi), which covers hi <= lo as well. Checking
+            // against the element found stops an inverted range running on
+            // past hi to end()
+            if (first == end() || !impl::compare_less(compare, *first, hi))
+            {
+                return const_range(first, first);
+            }
+            return const_range(first, lower_bound_impl(hi));
+        }
+
+        /** the number of levels build_balanced gives n elements */
+        static std::size_t balanced_height(std::size_t n)
+        {
+            std::size_t height = 0;
+            for (; n != 0; n >>= 1)
+            {
+                ++height;
+            }
+            return height;
+        }
+
+        /*
+         * builds the next n elements of it into a subtree whose root sits at
+         * depth in a tree with height levels. Splitting the elements evenly
+         * at each node means every level but the last is full
+         */
+        template <typename Iter>
+        static node_pointer build_balanced(Iter &it, std::size_t n,
+                                           std::size_t depth,
+                                           std::size_t height)
+        {
+            if (n == 0)
+            {
+                return nullptr;
+            }
+
+            auto const left_size = (n - 1) / 2;
+            auto left = build_balanced(it, left_size, depth + 1, height);
+
+            node_pointer node =
+                AllocationPolicy::template make_node<node_type>(T(*it));
+            ++it;
+
+            auto right =
+                build_balanced(it, n - 1 - left_size, depth + 1, height);
+            return bulk_load(std::move(node), std::move(left),
+                             std::move(right), depth, height);
+        }
+
+        /*
+         * build_balanced over a random access range, building the two
+         * subtrees of each node at the top of the tree on different threads.
+         * Every node's colour depends only on its depth so the subtrees can
+         * be built without knowing anything about each other. Pooled and
+         * indexed nodes made by a worker are freed like any others, and the
+         * slots a worker didn't use go back to the pool when it exits
+         */
+        template <typename Iter>
+        static node_pointer
+        build_balanced_parallel(Iter first, std::size_t n, std::size_t depth,
+                                std::size_t height, std::size_t threads)
+        {
+            // below this a subtree is built faster than a thread starts
+            constexpr std::size_t min_parallel_size = 1 << 14;
+            if (threads < 2 || n < min_parallel_size)
+            {
+                return build_balanced(first, n, depth, height);
+            }
+
+            auto const left_size = (n - 1) / 2;
+            auto const mid = first + left_size;
+
+            node_pointer left;
+            node_pointer right;
+            impl::run_parallel(2, 2, [&](std::size_t i) {
+                if (i == 0)
+                {
+                    left = build_balanced_parallel(first, left_size,
+                                                   depth + 1, height,
+                                                   threads / 2);
+                }
+                else
+                {
+                    right = build_balanced_parallel(
+                        mid + 1, n - 1 - left_size, depth + 1, height,
+                        threads - threads / 2);
+                }
+            });
+
+            return bulk_load(
+                AllocationPolicy::template make_node<node_type>(T(*mid)),
+                std::move(left), std::move(right), depth, height);
+        }
+
+        /** link a bulk loaded node to its subtrees */
+        static node_pointer bulk_load(node_pointer node, node_pointer left,
+                                      node_pointer right, std::size_t depth,
+                                      std::size_t height)
+        {
+            node->left = std::move(left);
+            node->right = std::move(right);
+
+            if (node->left != nullptr)
+            {
+                node->left->parent = node.get();
+            }
+            if (node->right != nullptr)
+            {
+                node->right->parent = node.get();
+            }
+
+            node->refresh();
+            BalancingPolicy::bulk_load_node(*node, depth, height);
+            return node;
+        }
+
+        node_pointer root = nullptr;
+        node_type *leftmost_node = nullptr;
+        node_type *rightmost_node = nullptr;
         std::size_t _size = 0;
+        Compare compare;
     };
 } // namespace csb
 
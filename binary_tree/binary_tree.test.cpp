@@ -2,6 +2,10 @@
 
 #include <catch2/catch.hpp>
 
+#include <functional>
+#include <iterator>
+#include <string>
+
 namespace csb::test
 {
 
@@ -400,6 +404,25 @@ namespace csb::test
                 }
             }
 
+            WHEN("moving it to another")
+            {
+                auto const first = b.begin();
+                binary_tree another(std::move(b));
+
+                THEN("iterators other than end() follow the nodes")
+                {
+                    REQUIRE(first == another.begin());
+                    REQUIRE(*std::next(first, 6) == 10);
+                    REQUIRE(std::next(first, 7) == another.end());
+                }
+
+                THEN("end() fetched again steps back to the largest element")
+                {
+                    REQUIRE(*std::prev(another.end()) == 10);
+                    REQUIRE(*another.rbegin() == 10);
+                }
+            }
+
             WHEN("assigning one to another")
             {
                 binary_tree another{6, 8, 3, 5, 9};
@@ -545,6 +568,282 @@ namespace csb::test
         }
     }
 
+    SCENARIO("bulk loading")
+    {
+        GIVEN("a sorted range of unique elements")
+        {
+            auto const sorted = std::vector{1, 2, 3, 4, 5, 6, 7};
+
+            WHEN("bulk loading a tree from it")
+            {
+                auto bt = binary_tree<int>::from_sorted(sorted.begin(),
+                                                        sorted.end());
+
+                THEN("the tree is perfectly balanced")
+                {
+                    std::vector<int> v;
+                    bt.breadth_first_traverse([&v](int i) { v.push_back(i); });
+                    REQUIRE_THAT(
+                        v, vector_equals(std::vector{4, 2, 6, 1, 3, 5, 7}));
+                }
+
+                THEN("it holds every element in order")
+                {
+                    REQUIRE(bt.size() == sorted.size());
+                    REQUIRE_THAT(make_vector(bt), vector_equals(sorted));
+                }
+
+                THEN("it can still be added to and erased from")
+                {
+                    bt.add(8);
+                    bt.erase(4);
+                    REQUIRE_THAT(make_vector(bt),
+                                 vector_equals(std::vector{
+                                     1, 2, 3, 5, 6, 7, 8}));
+                }
+            }
+        }
+
+        GIVEN("an empty range")
+        {
+            std::vector<int> empty;
+
+            WHEN("bulk loading a tree from it")
+            {
+                auto bt =
+                    binary_tree<int>::from_sorted(empty.begin(), empty.end());
+
+                THEN("the tree is empty")
+                {
+                    REQUIRE(bt.is_empty());
+                    REQUIRE(bt.begin() == bt.end());
+                }
+            }
+        }
+
+        GIVEN("an unsorted container with duplicates")
+        {
+            WHEN("constructing a tree from it")
+            {
+                binary_tree<int> bt(std::vector{5, 3, 9, 3, 1, 5, 7, 9});
+
+                THEN("the elements are sorted and deduped")
+                {
+                    REQUIRE(bt.size() == 5);
+                    REQUIRE_THAT(make_vector(bt),
+                                 vector_equals(std::vector{1, 3, 5, 7, 9}));
+                }
+            }
+        }
+    }
+
+    namespace
+    {
+        struct record
+        {
+            int id;
+            std::string name;
+        };
+
+        struct by_id
+        {
+            using is_transparent = void;
+
+            bool operator()(record const &l, record const &r) const
+            {
+                return l.id < r.id;
+            }
+            bool operator()(record const &l, int r) const { return l.id < r; }
+            bool operator()(int l, record const &r) const { return l < r.id; }
+        };
+
+        using record_tree = binary_tree<record, impl::null_balancing_policy,
+                                        impl::heap_allocation_policy, by_id>;
+    } // namespace
+
+    SCENARIO("custom comparators")
+    {
+        GIVEN("a tree ordered by std::greater")
+        {
+            binary_tree<int, impl::null_balancing_policy,
+                        impl::heap_allocation_policy, std::greater<int>>
+                bt{5, 10, 2, -3, 8};
+
+            THEN("it iterates largest to smallest")
+            {
+                REQUIRE_THAT(std::vector<int>(bt.begin(), bt.end()),
+                             vector_equals(std::vector{10, 8, 5, 2, -3}));
+            }
+
+            THEN("elements can still be found and erased")
+            {
+                REQUIRE(bt.contains(8));
+                bt.erase(8);
+                REQUIRE_FALSE(bt.contains(8));
+                REQUIRE(bt.size() == 4);
+            }
+        }
+
+        GIVEN("a tree with a transparent comparator")
+        {
+            record_tree bt;
+            bt.add({3, "three"});
+            bt.add({1, "one"});
+            bt.add({2, "two"});
+
+            WHEN("looking elements up by part of their key")
+            {
+                auto const found = bt.find(2);
+
+                THEN("the matching element is found")
+                {
+                    REQUIRE(found != bt.end());
+                    REQUIRE((*found).name == "two");
+                    REQUIRE(bt.contains(1));
+                    REQUIRE_FALSE(bt.contains(4));
+                }
+            }
+
+            WHEN("erasing elements by part of their key")
+            {
+                bt.erase(1);
+
+                THEN("the matching element is removed")
+                {
+                    REQUIRE(bt.size() == 2);
+                    REQUIRE_FALSE(bt.contains(1));
+                }
+            }
+        }
+    }
+
+    SCENARIO("three way comparators")
+    {
+        GIVEN("a balanced tree using a counting three way comparator")
+        {
+            struct counting_compare
+            {
+                int *count;
+
+                int operator()(int l, int r) const
+                {
+                    ++*count;
+                    return three_way_compare()(l, r);
+                }
+            };
+
+            int count = 0;
+            auto const sorted = std::vector{1, 2, 3, 4, 5, 6, 7};
+            auto bt = binary_tree<int, impl::null_balancing_policy,
+                                  impl::heap_allocation_policy,
+                                  counting_compare>::
+                from_sorted(sorted.begin(), sorted.end(),
+                            counting_compare{&count});
+
+            WHEN("finding a leaf")
+            {
+                auto const found = bt.find(7);
+
+                THEN("it is found with one comparison per level")
+                {
+                    REQUIRE(*found == 7);
+                    REQUIRE(count == 3);
+                }
+            }
+
+            WHEN("adding a new leaf")
+            {
+                bt.add(8);
+
+                THEN("it is placed with one comparison per level")
+                {
+                    REQUIRE(count == 3);
+                    REQUIRE_THAT(std::vector<int>(bt.begin(), bt.end()),
+                                 vector_equals(std::vector{
+                                     1, 2, 3, 4, 5, 6, 7, 8}));
+                }
+            }
+
+            WHEN("adding a duplicate")
+            {
+                bt.add(6);
+
+                THEN("it is rejected")
+                {
+                    REQUIRE(bt.size() == 7);
+                    REQUIRE(count == 2);
+                }
+            }
+        }
+    }
+
+    SCENARIO("degenerate trees")
+    {
+        GIVEN("a tree that is one long right hand chain")
+        {
+            using node_type = binary_tree<int>::node_type;
+
+            // built by hand, adding sorted input one at a time is quadratic
+            constexpr int depth = 200000;
+            auto root = std::make_unique<node_type>(0);
+            auto tail = root.get();
+            for (int i = 1; i != depth; ++i)
+            {
+                tail->right = std::make_unique<node_type>(int(i), tail);
+                tail = tail->right.get();
+            }
+
+            binary_tree<int> b(std::move(root));
+
+            THEN("the deepest element can be found")
+            {
+                REQUIRE(b.contains(depth - 1));
+                REQUIRE_FALSE(b.contains(depth));
+            }
+
+            WHEN("adding past the end of the chain")
+            {
+                b.add(depth);
+
+                THEN("it becomes the largest element")
+                {
+                    REQUIRE(b.size() == depth + 1);
+                    REQUIRE(*--b.end() == depth);
+                }
+            }
+
+            WHEN("erasing the deepest element")
+            {
+                b.erase(depth - 1);
+
+                THEN("it is removed")
+                {
+                    REQUIRE(b.size() == depth - 1);
+                    REQUIRE(*--b.end() == depth - 2);
+                }
+            }
+
+            WHEN("copying the tree")
+            {
+                auto const copy = b;
+
+                THEN("the copy is the same chain")
+                {
+                    REQUIRE(copy.size() == depth);
+                    REQUIRE(copy == b);
+                    REQUIRE(copy.begin().node().left == nullptr);
+                }
+            }
+
+            WHEN("clearing the tree")
+            {
+                b.clear();
+
+                THEN("it is empty") { REQUIRE(b.is_empty()); }
+            }
+        }
+    }
+
     SCENARIO("traversing backwards")
     {
         GIVEN("a populated binary tree")
@@ -589,4 +888,260 @@ namespace csb::test
             }
         }
     }
+
+    SCENARIO("bounds")
+    {
+        GIVEN("an empty binary_tree")
+        {
+            binary_tree<int> b;
+
+            THEN("every bound is end")
+            {
+                REQUIRE(b.lower_bound(1) == b.end());
+                REQUIRE(b.upper_bound(1) == b.end());
+                REQUIRE(b.equal_range(1).first == b.end());
+                REQUIRE(b.range(0, 10).is_empty());
+            }
+        }
+
+        GIVEN("a populated binary tree")
+        {
+            binary_tree b{5, 10, 2, -3, 8, 9, 7};
+
+            THEN("lower_bound finds the first element not less than the key")
+            {
+                REQUIRE(*b.lower_bound(-10) == -3);
+                REQUIRE(*b.lower_bound(5) == 5);
+                REQUIRE(*b.lower_bound(6) == 7);
+                REQUIRE(b.lower_bound(11) == b.end());
+            }
+
+            THEN("upper_bound finds the first element greater than the key")
+            {
+                REQUIRE(*b.upper_bound(-10) == -3);
+                REQUIRE(*b.upper_bound(5) == 7);
+                REQUIRE(*b.upper_bound(6) == 7);
+                REQUIRE(b.upper_bound(10) == b.end());
+            }
+
+            THEN("equal_range holds the element equal to the key")
+            {
+                auto const [first, last] = b.equal_range(8);
+                REQUIRE(*first == 8);
+                REQUIRE(std::distance(first, last) == 1);
+            }
+
+            THEN("equal_range is empty for a missing key")
+            {
+                auto const [first, last] = b.equal_range(6);
+                REQUIRE(first == last);
+                REQUIRE(*first == 7);
+            }
+
+            THEN("range holds every element in [lo, hi)")
+            {
+                auto const r = b.range(2, 9);
+                REQUIRE_THAT(std::vector<int>(r.begin(), r.end()),
+                             vector_equals(std::vector{2, 5, 7, 8}));
+            }
+
+            THEN("a range can run off either end of the tree")
+            {
+                auto const all = b.range(-100, 100);
+                REQUIRE(std::vector<int>(all.begin(), all.end()) ==
+                        make_vector(b));
+
+                auto const top = b.range(9, 100);
+                REQUIRE_THAT(std::vector<int>(top.begin(), top.end()),
+                             vector_equals(std::vector{9, 10}));
+            }
+
+            THEN("a range with nothing in it is empty")
+            {
+                REQUIRE(b.range(11, 20).is_empty());
+                REQUIRE(b.range(3, 5).is_empty());
+                REQUIRE(b.range(5, 5).is_empty());
+                REQUIRE(b.range(9, 2).is_empty());
+            }
+        }
+
+        GIVEN("a tree with a transparent comparator")
+        {
+            record_tree bt;
+            for (int i = 0; i != 10; ++i)
+            {
+                bt.add({i * 10, std::to_string(i)});
+            }
+
+            THEN("bounds and ranges can be found by part of the key")
+            {
+                REQUIRE((*bt.lower_bound(25)).id == 30);
+                REQUIRE((*bt.upper_bound(30)).id == 40);
+
+                std::vector<int> ids;
+                for (auto const &r : bt.range(15, 45))
+                {
+                    ids.push_back(r.id);
+                }
+                REQUIRE_THAT(ids, vector_equals(std::vector{20, 30, 40}));
+            }
+        }
+    }
+
+    SCENARIO("split and join")
+    {
+        GIVEN("a populated binary tree")
+        {
+            binary_tree b{5, 10, 2, -3, 8, 9, 7};
+
+            WHEN("splitting it")
+            {
+                auto upper = b.split(8);
+
+                THEN("the elements are divided at the key")
+                {
+                    REQUIRE_THAT(make_vector(b),
+                                 vector_equals(std::vector{-3, 2, 5, 7}));
+                    REQUIRE_THAT(make_vector(upper),
+                                 vector_equals(std::vector{8, 9, 10}));
+                    REQUIRE(b.size() == 4);
+                    REQUIRE(upper.size() == 3);
+                }
+
+                AND_WHEN("joining the halves back together")
+                {
+                    auto const joined =
+                        binary_tree<int>::join(std::move(b), std::move(upper));
+
+                    THEN("every element is back")
+                    {
+                        REQUIRE_THAT(make_vector(joined),
+                                     vector_equals(std::vector{
+                                         -3, 2, 5, 7, 8, 9, 10}));
+                        REQUIRE(joined.size() == 7);
+                        REQUIRE(b.is_empty());
+                    }
+                }
+            }
+
+            WHEN("splitting it below its smallest element")
+            {
+                auto upper = b.split(-10);
+
+                THEN("everything goes to the new tree")
+                {
+                    REQUIRE(b.is_empty());
+                    REQUIRE(b.size() == 0);
+                    REQUIRE(upper.size() == 7);
+                }
+            }
+        }
+    }
+
+    SCENARIO("min and max")
+    {
+        GIVEN("a populated binary tree")
+        {
+            binary_tree b{5, 10, 2, -3, 8, 9, 7};
+            auto const end = b.end();
+
+            THEN("min and max are the smallest and largest elements")
+            {
+                REQUIRE(b.min() == -3);
+                REQUIRE(b.max() == 10);
+            }
+
+            WHEN("adding new smallest and largest elements")
+            {
+                b.add(-4);
+                b.add(11);
+
+                THEN("min, max, begin and end all follow")
+                {
+                    REQUIRE(b.min() == -4);
+                    REQUIRE(b.max() == 11);
+                    REQUIRE(*b.begin() == -4);
+                    REQUIRE(*--b.end() == 11);
+                    auto before_end = end;
+                    REQUIRE(*--before_end == 11);
+                }
+            }
+
+            WHEN("erasing the smallest and largest elements")
+            {
+                b.erase(-3);
+                b.erase(10);
+
+                THEN("the next ones along take their place")
+                {
+                    REQUIRE(b.min() == 2);
+                    REQUIRE(b.max() == 9);
+                    REQUIRE(*--b.end() == 9);
+                }
+            }
+
+            WHEN("popping every element")
+            {
+                std::vector<int> popped;
+                while (!b.is_empty())
+                {
+                    popped.push_back(b.pop_min());
+                }
+
+                THEN("they come out smallest first")
+                {
+                    REQUIRE_THAT(popped, vector_equals(std::vector{
+                                             -3, 2, 5, 7, 8, 9, 10}));
+                    REQUIRE(b.size() == 0);
+                    REQUIRE(b.begin() == b.end());
+                }
+            }
+        }
+    }
+
+    SCENARIO("reverse iteration")
+    {
+        using traits = std::iterator_traits<binary_tree<int>::const_iterator>;
+        static_assert(std::is_same_v<traits::iterator_category,
+                                     std::bidirectional_iterator_tag>);
+
+        GIVEN("an empty binary_tree")
+        {
+            binary_tree<int> b;
+
+            THEN("rbegin is rend") { REQUIRE(b.rbegin() == b.rend()); }
+        }
+
+        GIVEN("a populated binary tree")
+        {
+            binary_tree b{5, 10, 2, -3, 8, 9, 7};
+
+            THEN("the reverse iterators go from largest to smallest")
+            {
+                REQUIRE_THAT(std::vector<int>(b.rbegin(), b.rend()),
+                             vector_equals(std::vector{10, 9, 8, 7, 5, 2, -3}));
+            }
+
+            THEN("the last few elements can be read without a copy")
+            {
+                std::vector<int> latest;
+                std::copy_n(b.rbegin(), 3, std::back_inserter(latest));
+                REQUIRE_THAT(latest, vector_equals(std::vector{10, 9, 8}));
+            }
+
+            THEN("std::prev steps back from end")
+            {
+                REQUIRE(*std::prev(b.end()) == 10);
+                REQUIRE(*std::prev(b.end(), 3) == 8);
+            }
+
+            THEN("reverse_inorder_traverse visits largest first")
+            {
+                std::vector<int> v;
+                b.reverse_inorder_traverse([&v](int i) { v.push_back(i); });
+                REQUIRE_THAT(v,
+                             vector_equals(std::vector{10, 9, 8, 7, 5, 2, -3}));
+            }
+        }
+    }
 } // namespace csb::test
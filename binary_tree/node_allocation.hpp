@@ -0,0 +1,773 @@
+#ifndef CSB_NODE_ALLOCATION_HPP
+#define CSB_NODE_ALLOCATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <experimental/type_traits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace csb
+{
+    namespace impl
+    {
+        /*
+         * Hands out fixed size slots carved out of large contiguous blocks.
+         * Freed slots are pushed onto a free list and handed straight back
+         * out by the next allocation, so a tree that is churning through
+         * inserts and erases stops touching the system allocator entirely.
+         *
+         * Each thread allocates from its own block and keeps its own free
+         * list so no locking is needed on the hot path. Slots only move
+         * between threads through a shared, locked, store:
+         *  - a thread whose free list grows past a block's worth, e.g. one
+         *    freeing nodes another thread allocated, hands the list over
+         *  - a thread that exits hands over its free list and whatever is
+         *    left of its block
+         *  - a thread that runs out takes from the store before it asks for
+         *    a new block
+         * so memory freed on one thread is reused by the others rather than
+         * stranded. The blocks themselves are owned by the pool for the
+         * life of the process. Pools are shared by everything with the same
+         * Size and Align, a distinct Tag gives a separate pool.
+         */
+        template <std::size_t Size, std::size_t Align, typename Tag = void>
+        class node_pool
+        {
+          public:
+            static void *allocate()
+            {
+                auto &s = local();
+
+                if (s.free.head == nullptr && s.cursor == s.end)
+                {
+                    refill(s);
+                }
+
+                if (s.free.head != nullptr)
+                {
+                    return s.free.pop();
+                }
+
+                return s.cursor++;
+            }
+
+            static void deallocate(void *p) noexcept
+            {
+                auto &s = local();
+                auto slot = static_cast<slot_type *>(p);
+
+                if (s.status != thread_status::live)
+                {
+                    deallocate_slow(s, slot);
+                    return;
+                }
+
+                s.free.push(slot);
+                if (s.free.count > slots_per_block)
+                {
+                    hand_over(s.free);
+                }
+            }
+
+          private:
+            union slot_type
+            {
+                slot_type *next;
+                alignas(Align) unsigned char storage[Size];
+            };
+
+            static constexpr std::size_t block_bytes = 64 * 1024;
+            static constexpr std::size_t slots_per_block =
+                block_bytes / sizeof(slot_type) > 16
+                    ? block_bytes / sizeof(slot_type)
+                    : 16;
+
+            struct free_list
+            {
+                slot_type *head = nullptr;
+                slot_type *tail = nullptr;
+                std::size_t count = 0;
+
+                void push(slot_type *slot)
+                {
+                    slot->next = head;
+                    if (head == nullptr)
+                    {
+                        tail = slot;
+                    }
+                    head = slot;
+                    ++count;
+                }
+
+                slot_type *pop()
+                {
+                    auto slot = head;
+                    head = slot->next;
+                    --count;
+                    return slot;
+                }
+
+                /** cut the first n slots, or all of them, off the list */
+                free_list take(std::size_t n)
+                {
+                    if (count <= n)
+                    {
+                        return std::exchange(*this, free_list());
+                    }
+
+                    free_list taken;
+                    taken.head = head;
+                    taken.tail = head;
+                    for (std::size_t i = 1; i != n; ++i)
+                    {
+                        taken.tail = taken.tail->next;
+                    }
+                    taken.count = n;
+
+                    head = taken.tail->next;
+                    taken.tail->next = nullptr;
+                    count -= n;
+                    return taken;
+                }
+
+                /** move all of other's slots onto the front of this list */
+                void splice(free_list &other)
+                {
+                    if (other.head == nullptr)
+                    {
+                        return;
+                    }
+                    other.tail->next = head;
+                    if (head == nullptr)
+                    {
+                        tail = other.tail;
+                    }
+                    head = other.head;
+                    count += other.count;
+                    other = free_list();
+                }
+            };
+
+            enum class thread_status : unsigned char
+            {
+                unregistered,
+                live,
+                exited
+            };
+
+            // kept trivially destructible so that nodes freed during static
+            // destruction (e.g. from a global tree) still have somewhere to
+            // go. thread_exit hands its slots over instead
+            struct thread_state
+            {
+                free_list free;
+                slot_type *cursor = nullptr;
+                slot_type *end = nullptr;
+                thread_status status = thread_status::unregistered;
+            };
+
+            struct block_registry
+            {
+                std::mutex mutex;
+                std::vector<std::unique_ptr<slot_type[]>> blocks;
+
+                // slots handed over by threads, for any thread to reuse
+                free_list free;
+            };
+
+            /** hands a thread's slots over when the thread exits */
+            struct thread_exit
+            {
+                thread_state *s;
+
+                ~thread_exit()
+                {
+                    while (s->cursor != s->end)
+                    {
+                        s->free.push(s->cursor++);
+                    }
+                    hand_over(s->free);
+                    s->status = thread_status::exited;
+                }
+            };
+
+            static thread_state &local()
+            {
+                thread_local thread_state s;
+                return s;
+            }
+
+            static block_registry &registry()
+            {
+                // deliberately never destroyed, live nodes may outlive any
+                // static that would own it
+                static auto *r = new block_registry();
+                return *r;
+            }
+
+            static void enroll(thread_state &s)
+            {
+                if (s.status == thread_status::unregistered)
+                {
+                    thread_local thread_exit on_exit{&s};
+                    s.status = thread_status::live;
+                }
+            }
+
+            /** s has run out, take the slots handed over or a new block */
+            static void refill(thread_state &s)
+            {
+                enroll(s);
+
+                auto &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                if (r.free.head != nullptr)
+                {
+                    // no more than a block's worth, or the next free would
+                    // hand them straight back
+                    auto taken = r.free.take(slots_per_block);
+                    s.free.splice(taken);
+                    return;
+                }
+
+                r.blocks.push_back(
+                    std::make_unique<slot_type[]>(slots_per_block));
+                s.cursor = r.blocks.back().get();
+                s.end = s.cursor + slots_per_block;
+            }
+
+            static void hand_over(free_list &free) noexcept
+            {
+                auto &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                r.free.splice(free);
+            }
+
+            static void deallocate_slow(thread_state &s,
+                                        slot_type *slot) noexcept
+            {
+                if (s.status == thread_status::unregistered)
+                {
+                    enroll(s);
+                    s.free.push(slot);
+                    return;
+                }
+
+                // the thread has exited and handed its slots over already
+                free_list late;
+                late.push(slot);
+                hand_over(late);
+            }
+        };
+
+        /*
+         * Default allocation policy. Every node is its own new/delete, this
+         * keeps binary_tree_node::pointer as a plain std::unique_ptr
+         */
+        struct heap_allocation_policy
+        {
+            template <typename Node> using deleter = std::default_delete<Node>;
+
+            template <typename Node, typename... Args>
+            static std::unique_ptr<Node> make_node(Args &&... args)
+            {
+                return std::make_unique<Node>(std::forward<Args>(args)...);
+            }
+        };
+
+        /*
+         * Allocates nodes out of a node_pool shared by every tree with the
+         * same node size. Nodes inserted one after the other end up next to
+         * each other in memory which also helps iteration
+         */
+        struct pool_allocation_policy
+        {
+            template <typename Node> struct deleter
+            {
+                void operator()(Node *n) const noexcept
+                {
+                    n->~Node();
+                    pool<Node>::deallocate(n);
+                }
+            };
+
+            template <typename Node, typename... Args>
+            static std::unique_ptr<Node, deleter<Node>>
+            make_node(Args &&... args)
+            {
+                auto p = pool<Node>::allocate();
+                try
+                {
+                    return std::unique_ptr<Node, deleter<Node>>(
+                        new (p) Node(std::forward<Args>(args)...));
+                }
+                catch (...)
+                {
+                    pool<Node>::deallocate(p);
+                    throw;
+                }
+            }
+
+          private:
+            template <typename Node>
+            using pool = node_pool<sizeof(Node), alignof(Node)>;
+        };
+
+        /*
+         * Like node_pool, but every slot is known by a 32 bit index rather
+         * than its address, so that a node can link to another in half the
+         * space of a pointer. Index 0 is never handed out and stands for
+         * null.
+         *
+         * Slots are carved out of blocks aligned to their own size, each of
+         * which starts with its number. Going from an index to an address
+         * looks the block up in a table, going back masks the address down
+         * to the start of its block. Blocks are never freed or moved, so a
+         * node's address stays valid for as long as it is alive. As with
+         * node_pool, a distinct Tag gives a separate arena.
+         */
+        template <std::size_t Size, std::size_t Align, typename Tag = void>
+        class node_arena
+        {
+          public:
+            using index_type = std::uint32_t;
+
+            static index_type allocate()
+            {
+                auto &s = local();
+
+                if (s.free.head == 0 && s.cursor == s.end)
+                {
+                    refill(s);
+                }
+
+                if (s.free.head != 0)
+                {
+                    return s.free.pop();
+                }
+
+                return s.cursor++;
+            }
+
+            static void deallocate(index_type i) noexcept
+            {
+                auto &s = local();
+
+                if (s.status != thread_status::live)
+                {
+                    deallocate_slow(s, i);
+                    return;
+                }
+
+                s.free.push(i);
+                if (s.free.count > slots_per_block)
+                {
+                    hand_over(s.free);
+                }
+            }
+
+            static void *address(index_type i) { return slot(i); }
+
+            static index_type index_of(void const *p)
+            {
+                auto const bits = reinterpret_cast<std::uintptr_t>(p);
+                auto const block = reinterpret_cast<block_type const *>(
+                    bits & ~(block_bytes - 1));
+                auto const offset = static_cast<index_type>(
+                    static_cast<slot_type const *>(p) - block->slots);
+                return block->number * slots_per_block + offset + 1;
+            }
+
+          private:
+            union slot_type
+            {
+                index_type next;
+                alignas(Align) unsigned char storage[Size];
+            };
+
+            static constexpr std::size_t block_bytes = 1 << 20;
+            static constexpr index_type slots_per_block =
+                (block_bytes - alignof(slot_type) - sizeof(index_type)) /
+                sizeof(slot_type);
+
+            struct block_type
+            {
+                index_type number;
+                slot_type slots[slots_per_block];
+            };
+
+            static_assert(sizeof(block_type) <= block_bytes);
+
+            // enough blocks to use up every index below the maximum
+            static constexpr index_type max_blocks =
+                (UINT32_MAX - 1) / slots_per_block;
+
+            // a free list threaded through the slots by index, as node_pool's
+            struct free_list
+            {
+                index_type head = 0;
+                index_type tail = 0;
+                index_type count = 0;
+
+                void push(index_type i)
+                {
+                    slot(i)->next = head;
+                    if (head == 0)
+                    {
+                        tail = i;
+                    }
+                    head = i;
+                    ++count;
+                }
+
+                index_type pop()
+                {
+                    auto const i = head;
+                    head = slot(i)->next;
+                    --count;
+                    return i;
+                }
+
+                free_list take(index_type n)
+                {
+                    if (count <= n)
+                    {
+                        return std::exchange(*this, free_list());
+                    }
+
+                    free_list taken;
+                    taken.head = head;
+                    taken.tail = head;
+                    for (index_type i = 1; i != n; ++i)
+                    {
+                        taken.tail = slot(taken.tail)->next;
+                    }
+                    taken.count = n;
+
+                    head = slot(taken.tail)->next;
+                    slot(taken.tail)->next = 0;
+                    count -= n;
+                    return taken;
+                }
+
+                void splice(free_list &other)
+                {
+                    if (other.head == 0)
+                    {
+                        return;
+                    }
+                    slot(other.tail)->next = head;
+                    if (head == 0)
+                    {
+                        tail = other.tail;
+                    }
+                    head = other.head;
+                    count += other.count;
+                    other = free_list();
+                }
+            };
+
+            enum class thread_status : unsigned char
+            {
+                unregistered,
+                live,
+                exited
+            };
+
+            struct thread_state
+            {
+                free_list free;
+                index_type cursor = 0;
+                index_type end = 0;
+                thread_status status = thread_status::unregistered;
+            };
+
+            struct block_registry
+            {
+                std::mutex mutex;
+                index_type count = 0;
+                free_list free;
+            };
+
+            struct thread_exit
+            {
+                thread_state *s;
+
+                ~thread_exit()
+                {
+                    while (s->cursor != s->end)
+                    {
+                        s->free.push(s->cursor++);
+                    }
+                    hand_over(s->free);
+                    s->status = thread_status::exited;
+                }
+            };
+
+            // zero initialised static storage, so the pages of the table no
+            // block has reached yet are never touched
+            static inline block_type *blocks[max_blocks] = {};
+
+            static slot_type *slot(index_type i)
+            {
+                auto const n = i - 1;
+                return &blocks[n / slots_per_block]->slots[n % slots_per_block];
+            }
+
+            static thread_state &local()
+            {
+                thread_local thread_state s;
+                return s;
+            }
+
+            static block_registry &registry()
+            {
+                // never destroyed for the same reason as node_pool's
+                static auto *r = new block_registry();
+                return *r;
+            }
+
+            static void enroll(thread_state &s)
+            {
+                if (s.status == thread_status::unregistered)
+                {
+                    thread_local thread_exit on_exit{&s};
+                    s.status = thread_status::live;
+                }
+            }
+
+            /** s has run out, take the slots handed over or a new block */
+            static void refill(thread_state &s)
+            {
+                enroll(s);
+
+                auto &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                if (r.free.head != 0)
+                {
+                    auto taken = r.free.take(slots_per_block);
+                    s.free.splice(taken);
+                    return;
+                }
+
+                if (r.count == max_blocks)
+                {
+                    throw std::bad_alloc();
+                }
+
+                auto block = static_cast<block_type *>(::operator new(
+                    block_bytes, std::align_val_t(block_bytes)));
+                block->number = r.count;
+                blocks[r.count] = block;
+                s.cursor = r.count++ * slots_per_block + 1;
+                s.end = s.cursor + slots_per_block;
+            }
+
+            static void hand_over(free_list &free) noexcept
+            {
+                auto &r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                r.free.splice(free);
+            }
+
+            static void deallocate_slow(thread_state &s,
+                                        index_type i) noexcept
+            {
+                if (s.status == thread_status::unregistered)
+                {
+                    enroll(s);
+                    s.free.push(i);
+                    return;
+                }
+
+                free_list late;
+                late.push(i);
+                hand_over(late);
+            }
+        };
+
+        template <typename Node>
+        using node_arena_of = node_arena<sizeof(Node), alignof(Node)>;
+
+        /*
+         * Owns a node allocated by index_allocation_policy, the way a
+         * std::unique_ptr would, but holds its 32 bit index
+         */
+        template <typename Node> class index_pointer
+        {
+          public:
+            index_pointer() = default;
+
+            index_pointer(std::nullptr_t) {}
+
+            index_pointer(index_pointer &&other) noexcept
+                  : index(std::exchange(other.index, 0))
+            {
+            }
+
+            index_pointer &operator=(index_pointer &&other) noexcept
+            {
+                // take other's node before destroying ours, which may be
+                // the one that other lives in
+                destroy(std::exchange(index, std::exchange(other.index, 0)));
+                return *this;
+            }
+
+            index_pointer &operator=(std::nullptr_t) noexcept
+            {
+                destroy(std::exchange(index, 0));
+                return *this;
+            }
+
+            ~index_pointer() { destroy(index); }
+
+            Node *get() const
+            {
+                return index == 0 ? nullptr
+                                  : static_cast<Node *>(
+                                        node_arena_of<Node>::address(index));
+            }
+
+            Node *operator->() const { return get(); }
+
+            Node &operator*() const { return *get(); }
+
+            explicit operator bool() const { return index != 0; }
+
+            friend bool operator==(index_pointer const &p, std::nullptr_t)
+            {
+                return p.index == 0;
+            }
+
+            friend bool operator!=(index_pointer const &p, std::nullptr_t)
+            {
+                return p.index != 0;
+            }
+
+            friend bool operator==(std::nullptr_t, index_pointer const &p)
+            {
+                return p.index == 0;
+            }
+
+            friend bool operator!=(std::nullptr_t, index_pointer const &p)
+            {
+                return p.index != 0;
+            }
+
+          private:
+            explicit index_pointer(std::uint32_t index) : index(index) {}
+
+            static void destroy(std::uint32_t index) noexcept
+            {
+                if (index != 0)
+                {
+                    static_cast<Node *>(node_arena_of<Node>::address(index))
+                        ->~Node();
+                    node_arena_of<Node>::deallocate(index);
+                }
+            }
+
+            std::uint32_t index = 0;
+
+            friend struct index_allocation_policy;
+        };
+
+        /*
+         * A node's link to its parent, by index. It converts to and from a
+         * Node * so it can stand in for one wherever the tree reads or
+         * assigns a parent
+         */
+        template <typename Node> class index_link
+        {
+          public:
+            index_link() = default;
+
+            /*implicit*/ index_link(Node *p)
+                  : index(p == nullptr ? 0 : node_arena_of<Node>::index_of(p))
+            {
+            }
+
+            Node *get() const
+            {
+                return index == 0 ? nullptr
+                                  : static_cast<Node *>(
+                                        node_arena_of<Node>::address(index));
+            }
+
+            /*implicit*/ operator Node *() const { return get(); }
+
+            Node *operator->() const { return get(); }
+
+            Node &operator*() const { return *get(); }
+
+          private:
+            std::uint32_t index = 0;
+        };
+
+        /*
+         * Allocates nodes out of a node_arena shared by every tree with the
+         * same node size, and links them by 32 bit index instead of by
+         * pointer. That halves the 24 bytes of links in every node, e.g. a
+         * binary_tree<int> node is 16 bytes rather than 32, at the cost of
+         * a table lookup whenever a link is followed. Limited to 4 billion
+         * live nodes of any one size.
+         *
+         * This only makes nodes smaller. The arena belongs to the process
+         * rather than to a tree, so a tree's nodes are mixed in with every
+         * other tree's and its indices mean nothing outside the process:
+         * the tree can't be relocated or serialised as a block of nodes
+         */
+        struct index_allocation_policy
+        {
+            template <typename Node> using pointer = index_pointer<Node>;
+
+            template <typename Node> using parent_pointer = index_link<Node>;
+
+            template <typename Node, typename... Args>
+            static index_pointer<Node> make_node(Args &&... args)
+            {
+                auto const i = node_arena_of<Node>::allocate();
+                try
+                {
+                    new (node_arena_of<Node>::address(i))
+                        Node(std::forward<Args>(args)...);
+                }
+                catch (...)
+                {
+                    node_arena_of<Node>::deallocate(i);
+                    throw;
+                }
+                return index_pointer<Node>(i);
+            }
+        };
+
+        template <typename AllocationPolicy, typename Node>
+        using policy_pointer_of =
+            typename AllocationPolicy::template pointer<Node>;
+
+        template <typename AllocationPolicy, typename Node>
+        using unique_pointer_of =
+            std::unique_ptr<Node, typename AllocationPolicy::template deleter<
+                                      Node>>;
+
+        /*
+         * how a node owns its children. A std::unique_ptr with the policy's
+         * deleter unless the policy has its own pointer type
+         */
+        template <typename AllocationPolicy, typename Node>
+        using node_pointer_t = std::conditional_t<
+            std::experimental::is_detected_v<policy_pointer_of,
+                                             AllocationPolicy, Node>,
+            std::experimental::detected_t<policy_pointer_of,
+                                          AllocationPolicy, Node>,
+            std::experimental::detected_t<unique_pointer_of,
+                                          AllocationPolicy, Node>>;
+    } // namespace impl
+} // namespace csb
+
+#endif // CSB_NODE_ALLOCATION_HPP
@@ -0,0 +1,344 @@
+#include "binary_tree/binary_tree.hpp"
+#include "binary_tree/node_allocation.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace csb::test
+{
+    namespace
+    {
+        template <typename T>
+        using pooled_tree = binary_tree<T, impl::null_balancing_policy,
+                                        impl::pool_allocation_policy>;
+
+        template <typename T>
+        using indexed_tree = binary_tree<T, impl::null_balancing_policy,
+                                         impl::index_allocation_policy>;
+
+        // tagged so the tests get the pools to themselves, trees with nodes
+        // of the same size use the untagged ones
+        using test_pool = impl::node_pool<40, 8, struct test_tag>;
+        using fresh_pool = impl::node_pool<48, 8, struct fresh_tag>;
+        using test_arena = impl::node_arena<44, 4, struct test_tag>;
+        using exit_pool = impl::node_pool<56, 8, struct exit_tag>;
+        using shared_pool = impl::node_pool<72, 8, struct shared_tag>;
+        using shared_arena = impl::node_arena<52, 4, struct shared_tag>;
+
+        template <typename Pool> auto allocate_n(std::size_t n)
+        {
+            std::vector<decltype(Pool::allocate())> slots;
+            for (std::size_t i = 0; i != n; ++i)
+            {
+                slots.push_back(Pool::allocate());
+            }
+            return slots;
+        }
+    } // namespace
+
+    SCENARIO("node pool")
+    {
+        GIVEN("a node pool")
+        {
+            WHEN("allocating several slots in a row")
+            {
+                auto a = static_cast<unsigned char *>(fresh_pool::allocate());
+                auto b = static_cast<unsigned char *>(fresh_pool::allocate());
+
+                THEN("they are handed out next to each other")
+                {
+                    REQUIRE(b - a == 48);
+                }
+
+                fresh_pool::deallocate(b);
+                fresh_pool::deallocate(a);
+            }
+
+            WHEN("a slot is freed")
+            {
+                auto a = test_pool::allocate();
+                test_pool::deallocate(a);
+
+                THEN("it is reused by the next allocation")
+                {
+                    auto b = test_pool::allocate();
+                    REQUIRE(a == b);
+                    test_pool::deallocate(b);
+                }
+            }
+        }
+    }
+
+    SCENARIO("slots move between threads")
+    {
+        GIVEN("a thread that allocates a slot from a pool and exits")
+        {
+            unsigned char *first = nullptr;
+            std::thread([&first] {
+                first = static_cast<unsigned char *>(exit_pool::allocate());
+            }).join();
+
+            THEN("the rest of its block is used by the next thread")
+            {
+                unsigned char *next = nullptr;
+                std::thread([&next] {
+                    next = static_cast<unsigned char *>(exit_pool::allocate());
+                }).join();
+
+                REQUIRE(next > first);
+                REQUIRE(next - first < 64 * 1024);
+                exit_pool::deallocate(next);
+            }
+
+            exit_pool::deallocate(first);
+        }
+
+        GIVEN("many slots allocated on this thread")
+        {
+            auto const slots = allocate_n<shared_pool>(5000);
+
+            WHEN("another thread frees them all and exits")
+            {
+                std::thread([&slots] {
+                    for (auto p : slots)
+                    {
+                        shared_pool::deallocate(p);
+                    }
+                }).join();
+
+                THEN("a new thread reuses them rather than new blocks")
+                {
+                    std::vector<void *> again;
+                    std::thread([&again] {
+                        again = allocate_n<shared_pool>(5000);
+                    }).join();
+
+                    std::set<void *> const before(slots.begin(),
+                                                  slots.end());
+                    REQUIRE(std::all_of(again.begin(), again.end(),
+                                        [&before](void *p) {
+                                            return before.count(p) == 1;
+                                        }));
+                    for (auto p : again)
+                    {
+                        shared_pool::deallocate(p);
+                    }
+                }
+            }
+        }
+
+        GIVEN("many indices allocated from an arena on this thread")
+        {
+            auto const indices = allocate_n<shared_arena>(70000);
+
+            WHEN("another thread frees them all and exits")
+            {
+                std::thread([&indices] {
+                    for (auto i : indices)
+                    {
+                        shared_arena::deallocate(i);
+                    }
+                }).join();
+
+                THEN("a new thread reuses them rather than new indices")
+                {
+                    std::vector<std::uint32_t> again;
+                    std::thread([&again] {
+                        again = allocate_n<shared_arena>(70000);
+                    }).join();
+
+                    std::sort(again.begin(), again.end());
+                    auto sorted = indices;
+                    std::sort(sorted.begin(), sorted.end());
+                    REQUIRE(again == sorted);
+                    for (auto i : again)
+                    {
+                        shared_arena::deallocate(i);
+                    }
+                }
+            }
+        }
+    }
+
+    SCENARIO("pool allocated binary_tree")
+    {
+        GIVEN("a tree using the pool allocation policy")
+        {
+            pooled_tree<int> bt{5, -1, 7, -20, 0, 42, -42, 2, 1, 20, 13};
+
+            THEN("it is ordered like any other tree")
+            {
+                REQUIRE_THAT(std::vector<int>(bt.begin(), bt.end()),
+                             Catch::Matchers::Equals(std::vector{
+                                 -42, -20, -1, 0, 1, 2, 5, 7, 13, 20, 42}));
+            }
+
+            WHEN("erasing and re-adding elements")
+            {
+                bt.erase(20);
+                bt.erase(-1);
+                bt.add(21);
+                bt.add(-2);
+
+                THEN("the tree is updated correctly")
+                {
+                    REQUIRE(bt.size() == 11);
+                    REQUIRE_THAT(std::vector<int>(bt.begin(), bt.end()),
+                                 Catch::Matchers::Equals(std::vector{
+                                     -42, -20, -2, 0, 1, 2, 5, 7, 13, 21, 42}));
+                }
+            }
+
+            WHEN("copying the tree")
+            {
+                auto copy = bt;
+                bt.erase(5);
+
+                THEN("the copy is unaffected")
+                {
+                    REQUIRE(copy.size() == 11);
+                    REQUIRE(copy.contains(5));
+                    REQUIRE_FALSE(bt.contains(5));
+                }
+            }
+        }
+
+        GIVEN("a tree of non-trivial types")
+        {
+            pooled_tree<std::string> bt{"one", "two", "three", "four"};
+
+            WHEN("erasing an element")
+            {
+                bt.erase("two");
+
+                THEN("the remaining elements are intact")
+                {
+                    REQUIRE_THAT(std::vector<std::string>(bt.begin(), bt.end()),
+                                 Catch::Matchers::Equals(
+                                     std::vector<std::string>{
+                                         "four", "one", "three"}));
+                }
+            }
+        }
+    }
+
+    SCENARIO("node arena")
+    {
+        GIVEN("a node arena")
+        {
+            WHEN("allocating several slots in a row")
+            {
+                auto const a = test_arena::allocate();
+                auto const b = test_arena::allocate();
+
+                THEN("they get consecutive indices and adjacent slots")
+                {
+                    REQUIRE(a != 0);
+                    REQUIRE(b == a + 1);
+                    REQUIRE(static_cast<unsigned char *>(
+                                test_arena::address(b)) -
+                                static_cast<unsigned char *>(
+                                    test_arena::address(a)) ==
+                            44);
+                }
+
+                THEN("each slot's address maps back to its index")
+                {
+                    REQUIRE(test_arena::index_of(test_arena::address(a)) == a);
+                    REQUIRE(test_arena::index_of(test_arena::address(b)) == b);
+                }
+
+                test_arena::deallocate(b);
+                test_arena::deallocate(a);
+            }
+
+            WHEN("a slot is freed")
+            {
+                auto const a = test_arena::allocate();
+                test_arena::deallocate(a);
+
+                THEN("its index is reused by the next allocation")
+                {
+                    auto const b = test_arena::allocate();
+                    REQUIRE(a == b);
+                    test_arena::deallocate(b);
+                }
+            }
+        }
+    }
+
+    SCENARIO("index linked binary_tree")
+    {
+        GIVEN("a tree using the index allocation policy")
+        {
+            indexed_tree<int> bt{5, -1, 7, -20, 0, 42, -42, 2, 1, 20, 13};
+
+            THEN("its nodes are half the size of pointer linked ones")
+            {
+                REQUIRE(sizeof(indexed_tree<int>::node_type) == 16);
+                REQUIRE(sizeof(pooled_tree<int>::node_type) == 32);
+            }
+
+            THEN("it is ordered like any other tree")
+            {
+                REQUIRE_THAT(std::vector<int>(bt.begin(), bt.end()),
+                             Catch::Matchers::Equals(std::vector{
+                                 -42, -20, -1, 0, 1, 2, 5, 7, 13, 20, 42}));
+            }
+
+            WHEN("erasing and re-adding elements")
+            {
+                bt.erase(5);
+                bt.erase(-1);
+                bt.add(21);
+                bt.add(-2);
+
+                THEN("the tree is updated correctly")
+                {
+                    REQUIRE(bt.size() == 11);
+                    REQUIRE_THAT(
+                        std::vector<int>(bt.rbegin(), bt.rend()),
+                        Catch::Matchers::Equals(std::vector{
+                            42, 21, 20, 13, 7, 2, 1, 0, -2, -20, -42}));
+                }
+            }
+
+            WHEN("copying the tree")
+            {
+                auto copy = bt;
+                bt.erase(5);
+
+                THEN("the copy is unaffected")
+                {
+                    REQUIRE(copy.size() == 11);
+                    REQUIRE(copy.contains(5));
+                    REQUIRE_FALSE(bt.contains(5));
+                }
+            }
+        }
+
+        GIVEN("a tree of non-trivial types")
+        {
+            indexed_tree<std::string> bt{"one", "two", "three", "four"};
+
+            WHEN("erasing an element")
+            {
+                bt.erase("two");
+
+                THEN("the remaining elements are intact")
+                {
+                    REQUIRE_THAT(std::vector<std::string>(bt.begin(), bt.end()),
+                                 Catch::Matchers::Equals(
+                                     std::vector<std::string>{
+                                         "four", "one", "three"}));
+                }
+            }
+        }
+    }
+} // namespace csb::test
@@ -0,0 +1,40 @@
+#ifndef CSB_NODE_HANDLE_HPP
+#define CSB_NODE_HANDLE_HPP
+
+#include <utility>
+
+namespace csb
+{
+    /*
+     * Owns a node that has been extracted from a binary_tree. Inserting the
+     * handle into another tree of the same type relinks the node, so an
+     * element can move between trees without freeing or allocating a node
+     * and without copying or moving the element itself
+     */
+    template <typename Node> class binary_tree_node_handle
+    {
+      public:
+        using value_type = typename Node::value_type;
+
+        binary_tree_node_handle() = default;
+
+        bool is_empty() const { return node == nullptr; }
+
+        explicit operator bool() const { return !is_empty(); }
+
+        value_type &value() const { return node->t; }
+
+      private:
+        explicit binary_tree_node_handle(typename Node::pointer node)
+              : node(std::move(node))
+        {
+        }
+
+        typename Node::pointer node = nullptr;
+
+        template <typename T, typename BP, typename AP, typename C>
+        friend class binary_tree;
+    };
+} // namespace csb
+
+#endif // CSB_NODE_HANDLE_HPP
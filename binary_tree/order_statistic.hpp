@@ -0,0 +1,67 @@
+#ifndef CSB_ORDER_STATISTIC_HPP
+#define CSB_ORDER_STATISTIC_HPP
+
+#include "tree_utils.hpp"
+
+#include <cstddef>
+#include <type_traits>
+
+namespace csb
+{
+    namespace impl
+    {
+        template <typename Node> std::size_t subtree_size(Node const *node)
+        {
+            return node == nullptr ? 0 : node->metadata().size;
+        }
+
+        /*
+         * Adds the size of each node's subtree on top of the metadata the
+         * balancing policy already keeps. Sizes are refreshed from the
+         * bottom up on insert, erase and every rotation, which is enough to
+         * find the nth element or the rank of a key in O(log n)
+         */
+        template <typename Metadata> struct order_statistic_meta_data : Metadata
+        {
+            std::size_t size = 1;
+
+            template <typename Node> static void refresh(Node &node)
+            {
+                node.metadata().size =
+                    1 + subtree_size(node.left.get()) +
+                    subtree_size(node.right.get());
+            }
+        };
+
+        /*
+         * wraps any balancing policy so that its nodes also track their
+         * subtree size. Balancing works exactly as before
+         */
+        template <typename BalancingPolicy>
+        struct order_statistic_policy : BalancingPolicy
+        {
+            using node_metadata_type = order_statistic_meta_data<
+                typename BalancingPolicy::node_metadata_type>;
+
+            template <typename T,
+                      typename AllocationPolicy = heap_allocation_policy>
+            using node_type =
+                binary_tree_node<T, node_metadata_type, AllocationPolicy>;
+        };
+
+        template <typename Policy> struct is_order_statistic : std::false_type
+        {
+        };
+
+        template <typename BalancingPolicy>
+        struct is_order_statistic<order_statistic_policy<BalancingPolicy>>
+              : std::true_type
+        {
+        };
+
+        template <typename Policy>
+        constexpr bool is_order_statistic_v = is_order_statistic<Policy>::value;
+    } // namespace impl
+} // namespace csb
+
+#endif // CSB_ORDER_STATISTIC_HPP
@@ -0,0 +1,151 @@
+#include "binary_tree/binary_tree.hpp"
+#include "binary_tree/order_statistic.hpp"
+#include "red_black_tree/red_black_tree.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace csb::test
+{
+    namespace
+    {
+        template <typename Tree> bool sizes_are_consistent(Tree const &tree)
+        {
+            for (auto it = tree.begin(); it != tree.end(); ++it)
+            {
+                auto const &n = it.node();
+                if (n.metadata().size != 1 + impl::subtree_size(n.left.get()) +
+                                             impl::subtree_size(n.right.get()))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        using order_statistic_bst = binary_tree<
+            int, impl::order_statistic_policy<impl::null_balancing_policy>>;
+    } // namespace
+
+    SCENARIO("order statistics on a plain binary tree")
+    {
+        GIVEN("a tree with subtree sizes")
+        {
+            order_statistic_bst bt{5, 10, 2, -3, 8, 9, 7};
+
+            THEN("nth returns elements in sorted order")
+            {
+                auto const sorted = std::vector{-3, 2, 5, 7, 8, 9, 10};
+                for (std::size_t i = 0; i != sorted.size(); ++i)
+                {
+                    REQUIRE(*bt.nth(i) == sorted[i]);
+                }
+            }
+
+            THEN("nth past the end returns end")
+            {
+                REQUIRE(bt.nth(7) == bt.end());
+            }
+
+            THEN("rank counts the elements less than a key")
+            {
+                REQUIRE(bt.rank(-10) == 0);
+                REQUIRE(bt.rank(-3) == 0);
+                REQUIRE(bt.rank(6) == 3);
+                REQUIRE(bt.rank(7) == 3);
+                REQUIRE(bt.rank(10) == 6);
+                REQUIRE(bt.rank(11) == 7);
+            }
+
+            WHEN("erasing a node with two children")
+            {
+                bt.erase(8);
+
+                THEN("the sizes are kept up to date")
+                {
+                    REQUIRE(sizes_are_consistent(bt));
+                    REQUIRE(*bt.nth(4) == 9);
+                    REQUIRE(bt.rank(10) == 5);
+                }
+            }
+        }
+
+        GIVEN("a bulk loaded tree")
+        {
+            std::vector<int> sorted{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+            auto bt = order_statistic_bst::from_sorted(sorted.begin(),
+                                                       sorted.end());
+
+            THEN("its sizes are filled in")
+            {
+                REQUIRE(sizes_are_consistent(bt));
+                REQUIRE(*bt.nth(9) == 10);
+            }
+        }
+    }
+
+    SCENARIO("order statistics on a red black tree")
+    {
+        GIVEN("an order statistic tree under random inserts and erases")
+        {
+            order_statistic_tree<int> rb;
+            std::vector<int> expected;
+
+            std::mt19937 gen(7);
+            std::uniform_int_distribution<> dis(0, 500);
+
+            for (int round = 0; round != 2000; ++round)
+            {
+                auto const v = dis(gen);
+                auto const pos =
+                    std::lower_bound(expected.begin(), expected.end(), v);
+
+                if (round % 3 == 2)
+                {
+                    rb.erase(v);
+                    if (pos != expected.end() && *pos == v)
+                    {
+                        expected.erase(pos);
+                    }
+                }
+                else
+                {
+                    rb.add(v);
+                    if (pos == expected.end() || *pos != v)
+                    {
+                        expected.insert(pos, v);
+                    }
+                }
+            }
+
+            THEN("every subtree size is correct after the rotations")
+            {
+                REQUIRE(rb.size() == expected.size());
+                REQUIRE(sizes_are_consistent(rb));
+            }
+
+            THEN("nth agrees with the sorted elements")
+            {
+                for (std::size_t i = 0; i != expected.size(); ++i)
+                {
+                    REQUIRE(*rb.nth(i) == expected[i]);
+                }
+                REQUIRE(rb.nth(expected.size()) == rb.end());
+            }
+
+            THEN("rank agrees with the sorted elements")
+            {
+                for (int v = -1; v != 502; ++v)
+                {
+                    auto const pos =
+                        std::lower_bound(expected.begin(), expected.end(), v);
+                    REQUIRE(rb.rank(v) ==
+                            static_cast<std::size_t>(pos - expected.begin()));
+                }
+            }
+        }
+    }
+} // namespace csb::test
@@ -0,0 +1,185 @@
+#ifndef CSB_PARALLEL_HPP
+#define CSB_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace csb
+{
+    namespace impl
+    {
+        /** the thread count parallel traversals use unless told otherwise */
+        inline std::size_t default_thread_count()
+        {
+            return std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        /*
+         * a value on a cache line of its own, for results written by
+         * different threads side by side. Being a struct it also keeps a
+         * vector of bools from packing them into shared bytes
+         */
+        template <typename R> struct alignas(64) padded
+        {
+            R value;
+        };
+
+        /** either a single node or the whole subtree under it */
+        template <typename Node> struct work_item
+        {
+            Node const *node;
+            bool whole_subtree;
+
+            template <typename Callable>
+            void visit(Callable const &visiter) const
+            {
+                if (whole_subtree)
+                {
+                    node->inorder_traverse(visiter);
+                }
+                else
+                {
+                    visiter(node->t);
+                }
+            }
+        };
+
+        /*
+         * cuts the tree under root into work items in key order, opening up
+         * one level of subtrees at a time until there are at least pieces
+         * subtrees. Each level doubles the subtrees of a balanced tree, so
+         * stopping after enough levels for pieces keeps a tree that is
+         * nothing but a spine from being cut into a work item per node
+         */
+        template <typename Node>
+        std::vector<work_item<Node>> split_work(Node const *root,
+                                                std::size_t pieces)
+        {
+            std::vector<work_item<Node>> items;
+            if (root == nullptr)
+            {
+                return items;
+            }
+            items.push_back({root, true});
+
+            for (std::size_t level = 1; level < pieces; level *= 2)
+            {
+                std::vector<work_item<Node>> next;
+                next.reserve(items.size() * 3);
+                for (auto const &item : items)
+                {
+                    if (!item.whole_subtree)
+                    {
+                        next.push_back(item);
+                        continue;
+                    }
+                    if (item.node->left != nullptr)
+                    {
+                        next.push_back({item.node->left.get(), true});
+                    }
+                    next.push_back({item.node, false});
+                    if (item.node->right != nullptr)
+                    {
+                        next.push_back({item.node->right.get(), true});
+                    }
+                }
+                items = std::move(next);
+            }
+            return items;
+        }
+
+        /*
+         * calls work(i) for every i in [0, count) on up to threads threads,
+         * the calling thread included. Each thread claims the next
+         * unclaimed index whenever it finishes one, so a thread that drew
+         * small items goes on to take work the others have not got to. The
+         * first exception thrown is rethrown once every thread has stopped
+         */
+        template <typename Work>
+        void run_parallel(std::size_t count, std::size_t threads,
+                          Work const &work)
+        {
+            std::atomic<std::size_t> next{0};
+            std::exception_ptr error;
+            std::mutex error_mutex;
+
+            auto const worker = [&]() {
+                try
+                {
+                    for (auto i = next++; i < count; i = next++)
+                    {
+                        work(i);
+                    }
+                }
+                catch (...)
+                {
+                    // stop the others picking up anything more
+                    next = count;
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (error == nullptr)
+                    {
+                        error = std::current_exception();
+                    }
+                }
+            };
+
+            std::vector<std::thread> helpers;
+            auto const helper_count = std::min(threads, count);
+            for (std::size_t i = 1; i < helper_count; ++i)
+            {
+                helpers.emplace_back(worker);
+            }
+            worker();
+            for (auto &t : helpers)
+            {
+                t.join();
+            }
+
+            if (error != nullptr)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+
+        /*
+         * sorts [first, last) by sorting a chunk per thread and then merging
+         * neighbouring chunks pairwise, each round of merges in parallel
+         */
+        template <typename Iter, typename Less>
+        void parallel_sort(Iter first, Iter last, Less const &less,
+                           std::size_t threads)
+        {
+            auto const n = static_cast<std::size_t>(last - first);
+
+            // below this a chunk is sorted faster than a thread starts
+            constexpr std::size_t min_chunk_size = 1 << 14;
+            auto const chunks =
+                std::max<std::size_t>(1, std::min(threads, n / min_chunk_size));
+            auto const bound = [=](std::size_t chunk) {
+                return first + static_cast<std::ptrdiff_t>(n * chunk / chunks);
+            };
+
+            run_parallel(chunks, threads, [&](std::size_t c) {
+                std::sort(bound(c), bound(c + 1), less);
+            });
+
+            for (std::size_t width = 1; width < chunks; width *= 2)
+            {
+                auto const merges = (chunks + width - 1) / (2 * width);
+                run_parallel(merges, threads, [&](std::size_t m) {
+                    auto const lo = 2 * width * m;
+                    std::inplace_merge(bound(lo), bound(lo + width),
+                                       bound(std::min(lo + 2 * width, chunks)),
+                                       less);
+                });
+            }
+        }
+    } // namespace impl
+} // namespace csb
+
+#endif // CSB_PARALLEL_HPP
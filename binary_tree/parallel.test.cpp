@@ -0,0 +1,237 @@
+#include "binary_tree/binary_tree.hpp"
+#include "binary_tree/parallel.hpp"
+#include "red_black_tree/red_black_tree.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace csb::test
+{
+    SCENARIO("parallel traversal of a red black tree")
+    {
+        GIVEN("a large tree")
+        {
+            red_black_tree<int> rb;
+            for (int i = 0; i != 10000; ++i)
+            {
+                rb.add(i * 7919 % 10007);
+            }
+            std::vector<int> const expected(rb.begin(), rb.end());
+            long const expected_sum =
+                std::accumulate(expected.begin(), expected.end(), 0L);
+
+            THEN("parallel_for_each visits every element exactly once")
+            {
+                for (std::size_t threads : {1, 2, 4, 7})
+                {
+                    std::vector<std::atomic<int>> seen(10007);
+                    rb.parallel_for_each(
+                        [&seen](int i) { ++seen[i]; }, threads);
+
+                    for (auto i : expected)
+                    {
+                        REQUIRE(seen[i] == 1);
+                    }
+                    REQUIRE(std::accumulate(seen.begin(), seen.end(), 0) ==
+                            static_cast<int>(expected.size()));
+                }
+            }
+
+            THEN("parallel_reduce agrees with a sequential sum")
+            {
+                for (std::size_t threads : {1, 3, 8})
+                {
+                    auto const sum = rb.parallel_reduce(
+                        0L, [](long acc, int i) { return acc + i; },
+                        std::plus<>(), threads);
+                    REQUIRE(sum == expected_sum);
+                }
+            }
+
+            THEN("parallel_reduce can reduce to a bool")
+            {
+                // each piece writes its own bool, which a std::vector<bool>
+                // of partials would have packed into shared bytes
+                for (int round = 0; round != 20; ++round)
+                {
+                    auto const all_small = rb.parallel_reduce(
+                        true, [](bool acc, int i) { return acc && i < 10007; },
+                        std::logical_and<>(), 8);
+                    auto const any_big = rb.parallel_reduce(
+                        false, [](bool acc, int i) { return acc || i > 10006; },
+                        std::logical_or<>(), 8);
+                    REQUIRE(all_small);
+                    REQUIRE_FALSE(any_big);
+                }
+            }
+
+            THEN("parallel_reduce combines the pieces in key order")
+            {
+                auto const collected = rb.parallel_reduce(
+                    std::vector<int>(),
+                    [](std::vector<int> acc, int i) {
+                        acc.push_back(i);
+                        return acc;
+                    },
+                    [](std::vector<int> l, std::vector<int> const &r) {
+                        l.insert(l.end(), r.begin(), r.end());
+                        return l;
+                    },
+                    4);
+                REQUIRE(collected == expected);
+            }
+
+            THEN("an exception thrown by the visiter reaches the caller")
+            {
+                REQUIRE_THROWS_AS(rb.parallel_for_each(
+                                      [](int i) {
+                                          if (i == 5000)
+                                          {
+                                              throw std::runtime_error("5000");
+                                          }
+                                      },
+                                      4),
+                                  std::runtime_error);
+            }
+        }
+
+        GIVEN("an empty tree")
+        {
+            red_black_tree<int> rb;
+
+            THEN("nothing is visited and reduce returns identity")
+            {
+                int visits = 0;
+                rb.parallel_for_each([&visits](int) { ++visits; }, 4);
+                REQUIRE(visits == 0);
+                REQUIRE(rb.parallel_reduce(
+                            std::string("empty"),
+                            [](std::string acc, int) { return acc; },
+                            std::plus<>(), 4) == "empty");
+            }
+        }
+    }
+
+    SCENARIO("parallel traversal of an unbalanced binary tree")
+    {
+        GIVEN("a tree that is nothing but a spine")
+        {
+            binary_tree<int> bt;
+            for (int i = 0; i != 1000; ++i)
+            {
+                bt.add(i);
+            }
+
+            THEN("parallel_reduce still sees every element in order")
+            {
+                auto const collected = bt.parallel_reduce(
+                    std::vector<int>(),
+                    [](std::vector<int> acc, int i) {
+                        acc.push_back(i);
+                        return acc;
+                    },
+                    [](std::vector<int> l, std::vector<int> const &r) {
+                        l.insert(l.end(), r.begin(), r.end());
+                        return l;
+                    },
+                    4);
+                REQUIRE(collected == std::vector<int>(bt.begin(), bt.end()));
+                REQUIRE(collected.size() == 1000);
+            }
+        }
+    }
+
+    SCENARIO("parallel bulk construction of a red black tree")
+    {
+        GIVEN("a large unsorted input with duplicates")
+        {
+            std::mt19937 gen(17);
+            std::uniform_int_distribution<int> dis(0, 150000);
+            std::vector<int> input;
+            for (int i = 0; i != 200000; ++i)
+            {
+                input.push_back(dis(gen));
+            }
+
+            auto expected = input;
+            std::sort(expected.begin(), expected.end());
+            expected.erase(std::unique(expected.begin(), expected.end()),
+                           expected.end());
+
+            THEN("any number of threads builds the same tree as one")
+            {
+                // the shape and colours depend only on the element count
+                red_black_tree<int> const sequential{std::vector<int>(input)};
+                auto const layout = [](auto const &tree) {
+                    std::vector<std::pair<int, impl::Colour>> nodes;
+                    tree.breadth_first_traverse_nodes([&nodes](auto const &n) {
+                        nodes.emplace_back(n.t, n.metadata().colour);
+                    });
+                    return nodes;
+                };
+
+                for (std::size_t threads : {1, 2, 3, 8})
+                {
+                    auto const rb =
+                        red_black_tree<int>::from_unsorted(input, threads);
+
+                    REQUIRE(rb.size() == expected.size());
+                    REQUIRE(std::equal(rb.begin(), rb.end(),
+                                       expected.begin(), expected.end()));
+                    REQUIRE(layout(rb) == layout(sequential));
+                }
+            }
+        }
+
+        GIVEN("trees that allocate their nodes from a pool or arena")
+        {
+            std::vector<int> input(100000);
+            std::iota(input.begin(), input.end(), 0);
+            std::shuffle(input.begin(), input.end(), std::mt19937(17));
+
+            THEN("from_unsorted builds them across threads and they work")
+            {
+                auto pooled =
+                    pooled_red_black_tree<int>::from_unsorted(input, 4);
+                auto indexed =
+                    indexed_red_black_tree<int>::from_unsorted(input, 4);
+
+                for (int i = 0; i < 100000; i += 2)
+                {
+                    pooled.erase(i);
+                    indexed.erase(i);
+                }
+                pooled.add(-1);
+                indexed.add(-1);
+
+                REQUIRE(pooled.size() == 50001);
+                REQUIRE(indexed.size() == 50001);
+                REQUIRE(std::equal(pooled.begin(), pooled.end(),
+                                   indexed.begin(), indexed.end()));
+                REQUIRE(*pooled.begin() == -1);
+                REQUIRE(*std::next(indexed.begin()) == 1);
+            }
+        }
+
+        GIVEN("an input too small to be worth splitting")
+        {
+            auto const rb =
+                red_black_tree<int>::from_unsorted({5, 3, 9, 3, 1}, 4);
+
+            THEN("it is still built")
+            {
+                REQUIRE(std::vector<int>(rb.begin(), rb.end()) ==
+                        std::vector<int>{1, 3, 5, 9});
+            }
+        }
+    }
+} // namespace csb::test
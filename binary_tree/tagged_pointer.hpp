@@ -0,0 +1,85 @@
+#ifndef CSB_TAGGED_POINTER_HPP
+#define CSB_TAGGED_POINTER_HPP
+
+#include <cstdint>
+#include <experimental/type_traits>
+
+namespace csb
+{
+    namespace impl
+    {
+        /*
+         * A pointer to a Node with a bool kept in its lowest bit, which is
+         * always clear in a real Node address as nodes hold pointers and so
+         * are at least 2 byte aligned.
+         *
+         * It stands in for a Node * wherever the tree reads or assigns one,
+         * but the tag belongs to whoever holds the pointer rather than to
+         * the address. So assigning a new address, even from another tagged
+         * pointer, keeps the tag that was already there
+         */
+        template <typename Node> class tagged_pointer
+        {
+          public:
+            tagged_pointer() = default;
+
+            /*implicit*/ tagged_pointer(Node *p)
+                  : bits(reinterpret_cast<std::uintptr_t>(p))
+            {
+            }
+
+            tagged_pointer(tagged_pointer const &) = default;
+
+            tagged_pointer &operator=(Node *p)
+            {
+                bits = reinterpret_cast<std::uintptr_t>(p) | (bits & tag_bit);
+                return *this;
+            }
+
+            tagged_pointer &operator=(tagged_pointer const &other)
+            {
+                return *this = other.get();
+            }
+
+            Node *get() const
+            {
+                return reinterpret_cast<Node *>(bits & ~tag_bit);
+            }
+
+            /*implicit*/ operator Node *() const { return get(); }
+
+            Node *operator->() const { return get(); }
+
+            Node &operator*() const { return *get(); }
+
+            bool tag() const { return (bits & tag_bit) != 0; }
+
+            void set_tag(bool tag)
+            {
+                bits = (bits & ~tag_bit) | (tag ? tag_bit : 0);
+            }
+
+          private:
+            static constexpr std::uintptr_t tag_bit = 1;
+
+            std::uintptr_t bits = 0;
+        };
+
+        template <typename Policy, typename Node>
+        using parent_pointer_of =
+            typename Policy::template parent_pointer<Node>;
+
+        /*
+         * the type of a node's parent pointer. A plain Node * unless the
+         * metadata asks for something else, e.g. a tagged_pointer to keep
+         * its own bits in, or failing that the allocation policy does
+         */
+        template <typename Metadata, typename AllocationPolicy, typename Node>
+        using parent_pointer_t = std::experimental::detected_or_t<
+            std::experimental::detected_or_t<Node *, parent_pointer_of,
+                                             AllocationPolicy, Node>,
+            parent_pointer_of, Metadata, Node>;
+    } // namespace impl
+} // namespace csb
+
+#endif // CSB_TAGGED_POINTER_HPP
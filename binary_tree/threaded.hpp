@@ -0,0 +1,218 @@
+#ifndef CSB_THREADED_HPP
+#define CSB_THREADED_HPP
+
+#include "order_statistic.hpp"
+#include "tree_utils.hpp"
+
+#include <experimental/type_traits>
+#include <type_traits>
+#include <utility>
+
+namespace csb
+{
+    namespace impl
+    {
+        /*
+         * Adds links to each node's in-order predecessor and successor on
+         * top of the metadata the balancing policy already keeps, so that
+         * stepping an iterator is a single load rather than a climb back up
+         * the tree. The links are untyped as the metadata is part of the
+         * node it would have to name, use next_node and prev_node to follow
+         * them
+         */
+        template <typename Metadata> struct threaded_meta_data : Metadata
+        {
+            void *next = nullptr;
+            void *prev = nullptr;
+        };
+
+        template <typename Node>
+        using next_link_t =
+            decltype(std::declval<Node const &>().metadata().next);
+
+        template <typename Node>
+        constexpr bool is_threaded_v =
+            std::experimental::is_detected_v<next_link_t, Node>;
+
+        template <typename Node> Node *next_node(Node const &node)
+        {
+            return static_cast<Node *>(node.metadata().next);
+        }
+
+        template <typename Node> Node *prev_node(Node const &node)
+        {
+            return static_cast<Node *>(node.metadata().prev);
+        }
+
+        /** make prev and next n's neighbours, either can be null */
+        template <typename Node> void thread(Node *prev, Node &n, Node *next)
+        {
+            n.metadata().prev = prev;
+            n.metadata().next = next;
+            if (prev != nullptr)
+            {
+                prev->metadata().next = &n;
+            }
+            if (next != nullptr)
+            {
+                next->metadata().prev = &n;
+            }
+        }
+
+        /** make n's neighbours each other's */
+        template <typename Node> void unthread(Node &n)
+        {
+            auto const prev = prev_node(n);
+            auto const next = next_node(n);
+            if (prev != nullptr)
+            {
+                prev->metadata().next = next;
+            }
+            if (next != nullptr)
+            {
+                next->metadata().prev = prev;
+            }
+            n.metadata().prev = nullptr;
+            n.metadata().next = nullptr;
+        }
+
+        /**
+         * cut the links from the ends of the subtree under root to whatever
+         * was either side of it, so it can be joined elsewhere on its own
+         */
+        template <typename Node> void cut_threads(Node *root)
+        {
+            if constexpr (is_threaded_v<Node>)
+            {
+                if (root != nullptr)
+                {
+                    leftmost(root)->metadata().prev = nullptr;
+                    rightmost(root)->metadata().next = nullptr;
+                }
+            }
+            else
+            {
+                (void)root;
+            }
+        }
+
+        /** thread every node of a whole tree from scratch, O(n) */
+        template <typename Node> void thread_subtree(Node *root)
+        {
+            if constexpr (is_threaded_v<Node>)
+            {
+                Node *prev = nullptr;
+                auto n = leftmost(root);
+                while (n != nullptr)
+                {
+                    n->metadata().prev = prev;
+                    if (prev != nullptr)
+                    {
+                        prev->metadata().next = n;
+                    }
+                    prev = n;
+
+                    // the usual climb to the successor, once per node
+                    if (n->right != nullptr)
+                    {
+                        n = leftmost(n->right.get());
+                    }
+                    else
+                    {
+                        while (n->parent != nullptr &&
+                               n == n->parent->right.get())
+                        {
+                            n = n->parent;
+                        }
+                        n = n->parent;
+                    }
+                }
+                if (prev != nullptr)
+                {
+                    prev->metadata().next = nullptr;
+                }
+            }
+            else
+            {
+                (void)root;
+            }
+        }
+
+        /*
+         * wraps any balancing policy so that its nodes are threaded. Each
+         * hook threads or unthreads the node it is handed and then balances
+         * exactly as before. Rotations never change the order of the nodes
+         * so they leave the threads alone
+         */
+        template <typename BalancingPolicy>
+        struct threaded_policy : BalancingPolicy
+        {
+            using node_metadata_type = threaded_meta_data<
+                typename BalancingPolicy::node_metadata_type>;
+
+            template <typename T,
+                      typename AllocationPolicy = heap_allocation_policy>
+            using node_type =
+                binary_tree_node<T, node_metadata_type, AllocationPolicy>;
+
+            template <typename Node>
+            static typename Node::pointer
+            balance(typename Node::pointer root, Node *node)
+            {
+                // node has only just been linked in under its parent, which
+                // is its successor if node is a left child and predecessor if
+                // it is a right one
+                auto const parent = node->parent;
+                if (parent == nullptr)
+                {
+                    thread<Node>(nullptr, *node, nullptr);
+                }
+                else if (is_left_child(*node))
+                {
+                    thread(prev_node(*parent), *node, parent);
+                }
+                else
+                {
+                    thread(parent, *node, next_node(*parent));
+                }
+
+                return BalancingPolicy::balance(std::move(root), node);
+            }
+
+            template <typename Node>
+            static typename Node::pointer
+            erase_node(typename Node::pointer root, Node &target,
+                       typename Node::pointer &removed)
+            {
+                // when target has two children its element is swapped with
+                // its successor's and the successor removed instead. The two
+                // are neighbours so unthreading whichever node goes keeps
+                // the rest in order
+                root = BalancingPolicy::erase_node(std::move(root), target,
+                                                   removed);
+                unthread(*removed);
+                return root;
+            }
+
+            template <typename Node>
+            static ranked_tree<typename Node::pointer>
+            join(ranked_tree<typename Node::pointer> left,
+                 typename Node::pointer mid,
+                 ranked_tree<typename Node::pointer> right)
+            {
+                thread(rightmost(left.root.get()), *mid,
+                       leftmost(right.root.get()));
+                return BalancingPolicy::template join<Node>(
+                    std::move(left), std::move(mid), std::move(right));
+            }
+        };
+
+        template <typename BalancingPolicy>
+        struct is_order_statistic<threaded_policy<BalancingPolicy>>
+              : is_order_statistic<BalancingPolicy>
+        {
+        };
+    } // namespace impl
+} // namespace csb
+
+#endif // CSB_THREADED_HPP
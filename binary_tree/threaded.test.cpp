@@ -0,0 +1,223 @@
+#include "binary_tree/binary_tree.hpp"
+#include "binary_tree/threaded.hpp"
+#include "red_black_tree/red_black_tree.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace csb::test
+{
+    namespace
+    {
+        /** walks the threads both ways and checks them against expected */
+        template <typename Tree>
+        bool threads_match(Tree const &tree, std::vector<int> const &expected)
+        {
+            std::vector<int> forward(tree.begin(), tree.end());
+            std::vector<int> backward(tree.rbegin(), tree.rend());
+            std::reverse(backward.begin(), backward.end());
+            return forward == expected && backward == expected;
+        }
+
+        using threaded_bst = binary_tree<
+            int, impl::threaded_policy<impl::null_balancing_policy>>;
+
+        using threaded_order_statistic_tree =
+            binary_tree<int,
+                        impl::threaded_policy<impl::order_statistic_policy<
+                            impl::red_black_tree_balancing>>>;
+    } // namespace
+
+    SCENARIO("threaded plain binary tree")
+    {
+        GIVEN("a tree built by adding")
+        {
+            threaded_bst bt{5, 10, 2, -3, 8, 9, 7};
+
+            THEN("the threads visit every element in order")
+            {
+                REQUIRE(threads_match(bt, {-3, 2, 5, 7, 8, 9, 10}));
+            }
+
+            WHEN("erasing a node with two children")
+            {
+                bt.erase(8);
+
+                THEN("its neighbours are threaded to each other")
+                {
+                    REQUIRE(threads_match(bt, {-3, 2, 5, 7, 9, 10}));
+                }
+            }
+
+            WHEN("copying it")
+            {
+                auto const cpy = bt;
+                bt.erase(5);
+
+                THEN("the copy has threads of its own")
+                {
+                    REQUIRE(threads_match(cpy, {-3, 2, 5, 7, 8, 9, 10}));
+                    REQUIRE(threads_match(bt, {-3, 2, 7, 8, 9, 10}));
+                }
+            }
+        }
+
+        GIVEN("a bulk loaded tree")
+        {
+            std::vector<int> sorted{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+            auto bt = threaded_bst::from_sorted(sorted.begin(), sorted.end());
+
+            THEN("it is threaded")
+            {
+                REQUIRE(threads_match(bt, sorted));
+            }
+        }
+    }
+
+    SCENARIO("threaded red black tree")
+    {
+        GIVEN("a tree under random inserts, erases, extracts and pops")
+        {
+            threaded_red_black_tree<int> rb;
+            std::vector<int> expected;
+
+            std::mt19937 gen(11);
+            std::uniform_int_distribution<> dis(0, 500);
+
+            for (int round = 0; round != 3000; ++round)
+            {
+                auto const v = dis(gen);
+                auto const pos =
+                    std::lower_bound(expected.begin(), expected.end(), v);
+                auto const present = pos != expected.end() && *pos == v;
+
+                switch (round % 5)
+                {
+                case 0:
+                    rb.erase(v);
+                    if (present)
+                    {
+                        expected.erase(pos);
+                    }
+                    break;
+                case 1:
+                    if (present)
+                    {
+                        auto handle = rb.extract(v);
+                        rb.insert(std::move(handle));
+                    }
+                    break;
+                case 2:
+                    if (!expected.empty() && v < 20)
+                    {
+                        REQUIRE(rb.pop_min() == expected.front());
+                        expected.erase(expected.begin());
+                    }
+                    break;
+                default:
+                    rb.add(rb.lower_bound(v), v);
+                    if (!present)
+                    {
+                        expected.insert(pos, v);
+                    }
+                }
+            }
+
+            THEN("the threads agree with the sorted elements")
+            {
+                REQUIRE(rb.size() == expected.size());
+                REQUIRE(threads_match(rb, expected));
+            }
+
+            WHEN("splitting it and joining it back up")
+            {
+                auto upper = rb.split(250);
+                auto const mid = std::lower_bound(
+                    expected.begin(), expected.end(), 250);
+
+                THEN("each half is threaded on its own")
+                {
+                    REQUIRE(threads_match(
+                        rb, std::vector<int>(expected.begin(), mid)));
+                    REQUIRE(threads_match(
+                        upper, std::vector<int>(mid, expected.end())));
+                }
+
+                THEN("joining threads the halves back together")
+                {
+                    auto joined = threaded_red_black_tree<int>::join(
+                        std::move(rb), std::move(upper));
+                    REQUIRE(threads_match(joined, expected));
+                }
+            }
+        }
+
+        GIVEN("two overlapping trees")
+        {
+            std::vector<int> evens;
+            std::vector<int> thirds;
+            for (int i = 0; i != 300; ++i)
+            {
+                evens.push_back(2 * i);
+                thirds.push_back(3 * i);
+            }
+            auto a = threaded_red_black_tree<int>::from_sorted(
+                evens.begin(), evens.end());
+            auto b = threaded_red_black_tree<int>::from_sorted(
+                thirds.begin(), thirds.end());
+
+            THEN("their union is threaded")
+            {
+                std::vector<int> expected;
+                std::set_union(evens.begin(), evens.end(), thirds.begin(),
+                               thirds.end(), std::back_inserter(expected));
+                auto const u = threaded_red_black_tree<int>::set_union(
+                    std::move(a), std::move(b));
+                REQUIRE(threads_match(u, expected));
+            }
+
+            THEN("their intersection is threaded")
+            {
+                std::vector<int> expected;
+                std::set_intersection(evens.begin(), evens.end(),
+                                      thirds.begin(), thirds.end(),
+                                      std::back_inserter(expected));
+                auto const i = threaded_red_black_tree<int>::set_intersection(
+                    std::move(a), std::move(b));
+                REQUIRE(threads_match(i, expected));
+            }
+
+            THEN("their difference is threaded")
+            {
+                std::vector<int> expected;
+                std::set_difference(evens.begin(), evens.end(),
+                                    thirds.begin(), thirds.end(),
+                                    std::back_inserter(expected));
+                auto const d = threaded_red_black_tree<int>::set_difference(
+                    std::move(a), std::move(b));
+                REQUIRE(threads_match(d, expected));
+            }
+        }
+
+        GIVEN("a threaded order statistic tree")
+        {
+            threaded_order_statistic_tree ost;
+            for (int i = 100; i != 0; --i)
+            {
+                ost.add(i * 7 % 101);
+            }
+
+            THEN("it still answers nth and rank")
+            {
+                REQUIRE(*ost.nth(0) == 1);
+                REQUIRE(*ost.nth(99) == 100);
+                REQUIRE(ost.rank(50) == 49);
+                REQUIRE(*std::next(ost.nth(10)) == 12);
+            }
+        }
+    }
+} // namespace csb::test
@@ -1,90 +1,167 @@
 #ifndef CSB_TREE_UTILS_HPP
 #define CSB_TREE_UTILS_HPP
 
+#include "node_allocation.hpp"
+#include "tagged_pointer.hpp"
+#include <core/compare.hpp>
+
+#include <cstddef>
+#include <experimental/type_traits>
+#include <functional>
 #include <memory>
 
 namespace csb
 {
-
-    template <typename T, typename Metadata>
+    namespace impl
+    {
+        template <typename Metadata, typename Node>
+        using refresh_t = decltype(Metadata::refresh(std::declval<Node &>()));
+
+        /*
+         * metadata that summarises a node's subtree (e.g. its size) has a
+         * static refresh(node) that recomputes it from the node's children.
+         * It is called bottom up whenever the shape of the tree changes
+         */
+        template <typename Metadata, typename Node>
+        constexpr bool is_augmented_v =
+            std::experimental::is_detected_v<refresh_t, Metadata, Node>;
+    } // namespace impl
+
+    template <typename T, typename Metadata,
+              typename AllocationPolicy = impl::heap_allocation_policy>
     struct binary_tree_node : private Metadata
     {
         using value_type = T;
+        using allocation_policy = AllocationPolicy;
+        using pointer =
+            impl::node_pointer_t<AllocationPolicy, binary_tree_node>;
+        using parent_pointer =
+            impl::parent_pointer_t<Metadata, AllocationPolicy,
+                                   binary_tree_node>;
+
+        /** whether Metadata keeps some of itself in the parent pointer */
+        static constexpr bool has_tagged_parent =
+            std::experimental::is_detected_v<impl::parent_pointer_of,
+                                             Metadata, binary_tree_node>;
 
         ~binary_tree_node() = default;
 
         Metadata &metadata() { return *this; }
         Metadata const &metadata() const { return *this; }
 
-        /** add node to bst. return whether or not node was added */
-        bool add(std::unique_ptr<binary_tree_node> &v)
+        static constexpr bool is_augmented =
+            impl::is_augmented_v<Metadata, binary_tree_node>;
+
+        /** recompute the metadata summarising this node's subtree */
+        void refresh()
         {
-            if (v->t < t)
+            if constexpr (is_augmented)
             {
-                if (left == nullptr)
-                {
-                    left = std::move(v);
-                    left->parent = this;
-                    return true;
-                }
-                else
-                {
-                    return left->add(v);
-                }
+                Metadata::refresh(*this);
             }
-            else if (t < v->t)
+        }
+
+        /** refresh this node and every node above it */
+        void refresh_path()
+        {
+            if constexpr (is_augmented)
             {
-                if (right == nullptr)
+                for (auto n = this; n != nullptr; n = n->parent)
                 {
-                    right = std::move(v);
-                    right->parent = this;
-                    return true;
+                    n->refresh();
                 }
-                else
-                {
-                    return right->add(v);
-                }
-            }
-            else
-            { // t == v->t
-                return false;
             }
         }
 
-        binary_tree_node *find(T const &target)
+        /**
+         * add node to bst. return whether or not node was added. A three
+         * way compare is only called once per level, a less than compare
+         * may be called twice
+         */
+        template <typename Compare = std::less<>>
+        bool add(pointer &v, Compare const &compare = Compare())
         {
-            if (t == target)
-            {
-                return this;
-            }
-
-            if (t < target)
+            // walk down iteratively, a degenerate tree can be as deep as it
+            // is large
+            auto n = this;
+            while (true)
             {
-                if (right == nullptr)
+                bool go_left = false;
+                if constexpr (impl::is_three_way_v<Compare, T>)
                 {
-                    return nullptr;
+                    auto const order = compare(v->t, n->t);
+                    if (order == 0)
+                    {
+                        return false;
+                    }
+                    go_left = order < 0;
                 }
                 else
                 {
-                    return right->find(target);
+                    go_left = compare(v->t, n->t);
+                    if (!go_left && !compare(n->t, v->t))
+                    { // n->t == v->t
+                        return false;
+                    }
                 }
+
+                // selecting the link rather than branching on it lets the
+                // compiler use a conditional move, the branch is a coin toss
+                // on random keys
+                auto &link = go_left ? n->left : n->right;
+                if (link == nullptr)
+                {
+                    link = std::move(v);
+                    link->parent = n;
+                    n->refresh_path();
+                    return true;
+                }
+
+                n = link.get();
             }
-            else
+        }
+
+        /**
+         * find the node equivalent to target. target can be anything compare
+         * can compare against a T
+         */
+        template <typename K, typename Compare = std::less<>>
+        binary_tree_node *find(K const &target,
+                               Compare const &compare = Compare())
+        {
+            auto n = this;
+            while (n != nullptr)
             {
-                if (left == nullptr)
+                bool go_right = false;
+                if constexpr (impl::is_three_way_v<Compare, T, K>)
                 {
-                    return nullptr;
+                    auto const order = compare(n->t, target);
+                    if (order == 0)
+                    {
+                        return n;
+                    }
+                    go_right = order < 0;
                 }
                 else
                 {
-                    return left->find(target);
+                    go_right = compare(n->t, target);
+                    if (!go_right && !compare(target, n->t))
+                    {
+                        return n;
+                    }
                 }
+
+                auto &next = go_right ? n->right : n->left;
+                n = next.get();
             }
+            return nullptr;
         }
 
-        binary_tree_node const *find(T const &target) const
+        template <typename K, typename Compare = std::less<>>
+        binary_tree_node const *find(K const &target,
+                                     Compare const &compare = Compare()) const
         {
-            return const_cast<binary_tree_node *>(this)->find(target);
+            return const_cast<binary_tree_node *>(this)->find(target, compare);
         }
 
         template <typename Callable>
@@ -103,6 +180,23 @@ namespace csb
             }
         }
 
+        /** inorder_traverse from the largest element down */
+        template <typename Callable>
+        void reverse_inorder_traverse(Callable const &visiter) const
+        {
+            if (right != nullptr)
+            {
+                right->reverse_inorder_traverse(visiter);
+            }
+
+            visiter(t);
+
+            if (left != nullptr)
+            {
+                left->reverse_inorder_traverse(visiter);
+            }
+        }
+
         template <typename Callable>
         void preorder_traverse(Callable const &visiter) const
         {
@@ -136,10 +230,35 @@ namespace csb
             visiter(t);
         }
 
+        /**
+         * forget the tree the node was in so it can be linked into another.
+         * The node must already have been detached from its children
+         */
+        void unlink()
+        {
+            parent = nullptr;
+            if constexpr (has_tagged_parent)
+            {
+                parent.set_tag(false);
+            }
+            metadata() = Metadata();
+            refresh();
+        }
+
+        /** takes on n's metadata, including any kept in its parent pointer */
+        void copy_metadata(binary_tree_node const &n)
+        {
+            metadata() = n.metadata();
+            if constexpr (has_tagged_parent)
+            {
+                parent.set_tag(n.parent.tag());
+            }
+        }
+
         T t;
-        std::unique_ptr<binary_tree_node> left = nullptr;
-        std::unique_ptr<binary_tree_node> right = nullptr;
-        binary_tree_node *parent = nullptr;
+        pointer left = nullptr;
+        pointer right = nullptr;
+        parent_pointer parent = nullptr;
 
         explicit binary_tree_node(T &&v, binary_tree_node *parent = nullptr)
               : Metadata(),
@@ -150,8 +269,7 @@ namespace csb
         {
         }
 
-        friend std::unique_ptr<binary_tree_node>
-        left_rotate(std::unique_ptr<binary_tree_node> grandparent)
+        friend pointer left_rotate(pointer grandparent)
         {
             auto tmp = std::move(grandparent->right);
             tmp->parent = grandparent->parent;
@@ -162,11 +280,12 @@ namespace csb
             }
             tmp->left = std::move(grandparent);
             tmp->left->parent = tmp.get();
-            return std::move(tmp);
+            tmp->left->refresh();
+            tmp->refresh();
+            return tmp;
         }
 
-        friend std::unique_ptr<binary_tree_node>
-        right_rotate(std::unique_ptr<binary_tree_node> grandparent)
+        friend pointer right_rotate(pointer grandparent)
         {
             auto tmp = std::move(grandparent->left);
             tmp->parent = grandparent->parent;
@@ -177,27 +296,27 @@ namespace csb
             }
             tmp->right = std::move(grandparent);
             tmp->right->parent = tmp.get();
-            return std::move(tmp);
+            tmp->right->refresh();
+            tmp->refresh();
+            return tmp;
         }
 
-        friend std::unique_ptr<binary_tree_node>
-        left_right_rotate(std::unique_ptr<binary_tree_node> grandparent)
+        friend pointer left_right_rotate(pointer grandparent)
         {
             grandparent->left = left_rotate(std::move(grandparent->left));
             return right_rotate(std::move(grandparent));
         }
 
-        friend std::unique_ptr<binary_tree_node>
-        right_left_rotate(std::unique_ptr<binary_tree_node> grandparent)
+        friend pointer right_left_rotate(pointer grandparent)
         {
             grandparent->right = right_rotate(std::move(grandparent->right));
             return left_rotate(std::move(grandparent));
         }
     };
 
-    template <typename T, typename Metadata>
-    binary_tree_node<T, Metadata> *
-    find_replacement(binary_tree_node<T, Metadata> &target)
+    template <typename T, typename Metadata, typename A>
+    binary_tree_node<T, Metadata, A> *
+    find_replacement(binary_tree_node<T, Metadata, A> &target)
     {
         if (target.left != nullptr && target.right != nullptr)
         {
@@ -219,12 +338,17 @@ namespace csb
         }
     }
 
-    // Note, doesnt work with nodes with 2 children
-    template <typename T, typename Metadata>
-    std::unique_ptr<binary_tree_node<T, Metadata>>
-    detach(std::unique_ptr<binary_tree_node<T, Metadata>> root,
-           binary_tree_node<T, Metadata> &target,
-           std::unique_ptr<binary_tree_node<T, Metadata>> child = nullptr)
+    /*
+     * Note, doesnt work with nodes with 2 children. target is unlinked and
+     * handed back through detached rather than destroyed, so that it can be
+     * reused
+     */
+    template <typename T, typename Metadata, typename A>
+    typename binary_tree_node<T, Metadata, A>::pointer
+    detach(typename binary_tree_node<T, Metadata, A>::pointer root,
+           binary_tree_node<T, Metadata, A> &target,
+           typename binary_tree_node<T, Metadata, A>::pointer &detached,
+           typename binary_tree_node<T, Metadata, A>::pointer child = nullptr)
     {
         if (child != nullptr)
         {
@@ -233,23 +357,22 @@ namespace csb
 
         if (target.parent == nullptr) // target is root
         {
-            return std::move(child);
+            detached = std::move(root);
+            return child;
         }
 
-        if (is_left_child(target))
-        {
-            target.parent->left = std::move(child);
-        }
-        else
-        {
-            target.parent->right = std::move(child);
-        }
+        auto parent = target.parent;
+        auto &link = is_left_child(target) ? parent->left : parent->right;
+        detached = std::move(link);
+        link = std::move(child);
 
-        return std::move(root);
+        parent->refresh_path();
+        return root;
     }
 
-    template <typename T, typename Metadata>
-    binary_tree_node<T, Metadata> *leftmost(binary_tree_node<T, Metadata> *n)
+    template <typename T, typename Metadata, typename A>
+    binary_tree_node<T, Metadata, A> *
+    leftmost(binary_tree_node<T, Metadata, A> *n)
     {
         while (n && n->left)
         {
@@ -258,8 +381,9 @@ namespace csb
         return n;
     }
 
-    template <typename T, typename Metadata>
-    binary_tree_node<T, Metadata> *rightmost(binary_tree_node<T, Metadata> *n)
+    template <typename T, typename Metadata, typename A>
+    binary_tree_node<T, Metadata, A> *
+    rightmost(binary_tree_node<T, Metadata, A> *n)
     {
         while (n && n->right)
         {
@@ -268,12 +392,142 @@ namespace csb
         return n;
     }
 
-    template <typename T, typename Metadata>
-    bool is_left_child(binary_tree_node<T, Metadata> const &n)
+    /** make left and right the children of n, replacing any it had */
+    template <typename T, typename Metadata, typename A>
+    void adopt(binary_tree_node<T, Metadata, A> &n,
+               typename binary_tree_node<T, Metadata, A>::pointer left,
+               typename binary_tree_node<T, Metadata, A>::pointer right)
+    {
+        n.left = std::move(left);
+        n.right = std::move(right);
+        if (n.left != nullptr)
+        {
+            n.left->parent = &n;
+        }
+        if (n.right != nullptr)
+        {
+            n.right->parent = &n;
+        }
+        n.refresh();
+    }
+
+    /*
+     * a subtree along with its rank, whatever its balancing policy joins
+     * trees by, e.g. the black height of a red black tree. A split works
+     * out the ranks of the pieces it cuts on the way down from the root's,
+     * so that joining them back up never has to measure one
+     */
+    template <typename Pointer> struct ranked_tree
+    {
+        Pointer root;
+        std::size_t rank = 0;
+    };
+
+    template <typename T, typename Metadata, typename A>
+    bool is_left_child(binary_tree_node<T, Metadata, A> const &n)
     {
         return (n.parent != nullptr && n.parent->left.get() == &n);
     }
 
+    /** refresh every node under root, children before their parents */
+    template <typename T, typename Metadata, typename A>
+    void refresh_subtree(binary_tree_node<T, Metadata, A> *root)
+    {
+        if constexpr (binary_tree_node<T, Metadata, A>::is_augmented)
+        {
+            // first node in post order under n
+            auto const deepest = [](binary_tree_node<T, Metadata, A> *n) {
+                while (n->left != nullptr || n->right != nullptr)
+                {
+                    n = n->left != nullptr ? n->left.get() : n->right.get();
+                }
+                return n;
+            };
+
+            if (root == nullptr)
+            {
+                return;
+            }
+
+            auto n = deepest(root);
+            while (true)
+            {
+                n->refresh();
+                if (n == root)
+                {
+                    return;
+                }
+
+                auto parent = n->parent;
+                if (is_left_child(*n) && parent->right != nullptr)
+                {
+                    n = deepest(parent->right.get());
+                }
+                else
+                {
+                    n = parent;
+                }
+            }
+        }
+        else
+        {
+            (void)root;
+        }
+    }
+
+    /**
+     * copy the tree under root node for node, keeping its shape and each
+     * node's metadata so that nothing needs comparing or rebalancing. Walks
+     * the two trees in step without recursing, allocating the copies in
+     * pre-order so that a pool allocator lays each parent out next to its
+     * left child
+     */
+    template <typename T, typename Metadata, typename A>
+    typename binary_tree_node<T, Metadata, A>::pointer
+    clone_subtree(binary_tree_node<T, Metadata, A> const *root)
+    {
+        using node = binary_tree_node<T, Metadata, A>;
+
+        auto const copy_of = [](node const &n, node *parent) {
+            auto copy = A::template make_node<node>(T(n.t), parent);
+            copy->copy_metadata(n);
+            return copy;
+        };
+
+        if (root == nullptr)
+        {
+            return nullptr;
+        }
+
+        auto copy = copy_of(*root, nullptr);
+        auto from = root;
+        auto to = copy.get();
+        while (true)
+        {
+            if (from->left != nullptr && to->left == nullptr)
+            {
+                to->left = copy_of(*from->left, to);
+                from = from->left.get();
+                to = to->left.get();
+            }
+            else if (from->right != nullptr && to->right == nullptr)
+            {
+                to->right = copy_of(*from->right, to);
+                from = from->right.get();
+                to = to->right.get();
+            }
+            else if (from == root)
+            {
+                return copy;
+            }
+            else
+            {
+                from = from->parent;
+                to = to->parent;
+            }
+        }
+    }
+
 } // namespace csb
 
 #endif // CSB_TREE_UTILS_HPP
@@ -0,0 +1,145 @@
+#include "concurrent_set/concurrent_set.hpp"
+#include "red_black_tree/red_black_tree.hpp"
+#include "sharded_tree/sharded_tree.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace csb::bench
+{
+    namespace
+    {
+        constexpr int key_range = 100000;
+        constexpr int total_ops = 200000;
+
+        /** the red black tree behind one big lock, what we used to do */
+        struct locked_red_black_tree
+        {
+            bool contains(int k) const
+            {
+                std::lock_guard<std::mutex> lock(m);
+                return rb.contains(k);
+            }
+
+            void add(int k)
+            {
+                std::lock_guard<std::mutex> lock(m);
+                rb.add(k);
+            }
+
+            void erase(int k)
+            {
+                std::lock_guard<std::mutex> lock(m);
+                rb.erase(k);
+            }
+
+            mutable std::mutex m;
+            red_black_tree<int> rb;
+        };
+
+        /*
+         * splits total_ops between threads, each doing writes_in_100 adds or
+         * erases in every 100 operations and lookups for the rest, over a
+         * set starting half full
+         */
+        template <typename Set>
+        int run_mix(Set &set, int threads, int writes_in_100)
+        {
+            std::vector<std::thread> workers;
+            std::vector<int> hits(threads);
+            for (int t = 0; t != threads; ++t)
+            {
+                workers.emplace_back([&, t]() {
+                    std::minstd_rand gen(t + 1);
+                    std::uniform_int_distribution<int> key(0, key_range);
+                    std::uniform_int_distribution<int> op(0, 99);
+                    for (int i = 0; i != total_ops / threads; ++i)
+                    {
+                        auto const k = key(gen);
+                        auto const o = op(gen);
+                        if (o >= writes_in_100)
+                        {
+                            hits[t] += set.contains(k);
+                        }
+                        else if (o % 2 == 0)
+                        {
+                            set.add(k);
+                        }
+                        else
+                        {
+                            set.erase(k);
+                        }
+                    }
+                });
+            }
+            for (auto &w : workers)
+            {
+                w.join();
+            }
+
+            int total = 0;
+            for (auto h : hits)
+            {
+                total += h;
+            }
+            return total;
+        }
+
+        template <typename Set> void fill_half(Set &set)
+        {
+            for (int k = 0; k < key_range; k += 2)
+            {
+                set.add(k);
+            }
+        }
+    } // namespace
+
+    TEST_CASE("concurrent_set and sharded_tree vs a locked red_black_tree",
+              "[benchmark]")
+    {
+        concurrent_set<int> concurrent;
+        locked_red_black_tree locked;
+
+        // 64 shards evenly over the keys, one per thread at the most
+        std::vector<int> bounds;
+        for (int i = 1; i != 64; ++i)
+        {
+            bounds.push_back(i * key_range / 64);
+        }
+        sharded_tree<int> sharded(bounds);
+
+        fill_half(concurrent);
+        fill_half(locked);
+        fill_half(sharded);
+
+        for (int writes : {0, 10, 50})
+        {
+            for (int threads : {1, 2, 4, 8, 16, 32, 64})
+            {
+                auto const suffix = ", " + std::to_string(writes) +
+                                    "% writes, " + std::to_string(threads) +
+                                    " threads, 200K ops";
+
+                BENCHMARK("locked red_black_tree" + suffix)
+                {
+                    return run_mix(locked, threads, writes);
+                };
+
+                BENCHMARK("concurrent_set" + suffix)
+                {
+                    return run_mix(concurrent, threads, writes);
+                };
+
+                BENCHMARK("sharded_tree" + suffix)
+                {
+                    return run_mix(sharded, threads, writes);
+                };
+            }
+        }
+    }
+} // namespace csb::bench
@@ -0,0 +1,389 @@
+#ifndef CSB_CONCURRENT_SET_HPP
+#define CSB_CONCURRENT_SET_HPP
+
+#include <core/compare.hpp>
+#include <core/epoch.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <utility>
+
+namespace csb
+{
+    namespace impl
+    {
+        /*
+         * the part of a skip list node that does not depend on the element,
+         * which is all the head needs
+         */
+        struct skip_node_base
+        {
+            explicit skip_node_base(int top_level)
+                  : top_level(top_level),
+                    next(new std::atomic<skip_node_base *>[top_level + 1])
+            {
+                for (int level = 0; level <= top_level; ++level)
+                {
+                    next[level].store(nullptr, std::memory_order_relaxed);
+                }
+            }
+
+            int const top_level;
+            std::unique_ptr<std::atomic<skip_node_base *>[]> next;
+            std::mutex lock;
+            // set once the node is being erased, it is then unlinked from
+            // the top level down
+            std::atomic<bool> marked{false};
+            // set once the node is linked in on every level
+            std::atomic<bool> fully_linked{false};
+        };
+
+        template <typename T> struct skip_node : skip_node_base
+        {
+            skip_node(int top_level, T &&t)
+                  : skip_node_base(top_level), t(std::move(t))
+            {
+            }
+
+            T t;
+        };
+    } // namespace impl
+
+    /*
+     * An ordered set many threads can add to, erase from and search at
+     * once. It is a lazy skip list (Herlihy, Lev, Luchangco and Shavit):
+     *  - contains and find take no locks at all, they walk down the levels
+     *    and only look at whether the node they land on is live
+     *  - add and erase search without locking too, then lock just the
+     *    predecessors they are about to change and check nothing moved
+     *    underneath them, retrying the search if it did
+     *
+     * Erased nodes are handed to impl::epoch rather than deleted so a
+     * reader still walking over one is never left with a dangling pointer.
+     *
+     * Unlike binary_tree there are no iterators, an iterator would have to
+     * keep a reader pinned for as long as it lived. find returns a copy of
+     * the element instead and for_each visits the elements in key order
+     * inside a single guard
+     */
+    template <typename T, typename Compare = std::less<T>>
+    class concurrent_set
+    {
+      public:
+        using value_type = T;
+        using key_compare = Compare;
+
+        concurrent_set() = default;
+
+        explicit concurrent_set(Compare const &compare) : compare(compare) {}
+
+        concurrent_set(concurrent_set const &) = delete;
+        concurrent_set &operator=(concurrent_set const &) = delete;
+
+        /** must not race with anything else using the set */
+        ~concurrent_set()
+        {
+            auto n = head.next[0].load();
+            while (n != nullptr)
+            {
+                auto const next = n->next[0].load();
+                delete as_node(n);
+                n = next;
+            }
+        }
+
+        /** false if an equivalent element was already in the set */
+        bool add(T t)
+        {
+            auto const top_level = random_level();
+            window w;
+            impl::epoch::guard guard;
+
+            while (true)
+            {
+                auto const found = search(t, w);
+                if (found != -1)
+                {
+                    auto const n = w.succs[found];
+                    if (!n->marked.load())
+                    {
+                        // a concurrent add got there first, wait for it to
+                        // finish so that contains sees t once we return
+                        while (!n->fully_linked.load())
+                        {
+                        }
+                        return false;
+                    }
+                    // it is being erased, try again once it is gone
+                    continue;
+                }
+
+                locks held;
+                auto valid = true;
+                for (int level = 0; valid && level <= top_level; ++level)
+                {
+                    auto const pred = w.preds[level];
+                    auto const succ = w.succs[level];
+                    held.lock(pred);
+                    valid = !pred->marked.load() &&
+                            (succ == nullptr || !succ->marked.load()) &&
+                            pred->next[level].load() == succ;
+                }
+                if (!valid)
+                {
+                    continue;
+                }
+
+                auto const n = new impl::skip_node<T>(top_level, std::move(t));
+                for (int level = 0; level <= top_level; ++level)
+                {
+                    n->next[level].store(w.succs[level],
+                                         std::memory_order_relaxed);
+                }
+                for (int level = 0; level <= top_level; ++level)
+                {
+                    w.preds[level]->next[level].store(n);
+                }
+                n->fully_linked.store(true);
+                ++_size;
+                return true;
+            }
+        }
+
+        /** false if there was no equivalent element to erase */
+        bool erase(T const &t) { return erase_impl(t); }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        bool erase(K const &k)
+        {
+            return erase_impl(k);
+        }
+
+        bool contains(T const &t) const { return contains_impl(t); }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        bool contains(K const &k) const
+        {
+            return contains_impl(k);
+        }
+
+        /** a copy of the element equivalent to t, if there is one */
+        std::optional<T> find(T const &t) const { return find_impl(t); }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        std::optional<T> find(K const &k) const
+        {
+            return find_impl(k);
+        }
+
+        /*
+         * visits the elements in key order. Elements added or erased while
+         * it runs may or may not be seen, but no element is seen twice and
+         * every element present throughout is seen
+         */
+        template <typename Callable>
+        void for_each(Callable const &visiter) const
+        {
+            impl::epoch::guard guard;
+            for (auto n = head.next[0].load(); n != nullptr;
+                 n = n->next[0].load())
+            {
+                if (n->fully_linked.load() && !n->marked.load())
+                {
+                    visiter(as_node(n)->t);
+                }
+            }
+        }
+
+        /** exact when nothing is changing the set, a snapshot otherwise */
+        std::size_t size() const { return _size.load(); }
+
+        bool is_empty() const { return size() == 0; }
+
+      private:
+        using node_base = impl::skip_node_base;
+        using node = impl::skip_node<T>;
+
+        // with a 1 in 4 chance of each extra level this is plenty for
+        // billions of elements
+        static constexpr int max_level = 16;
+
+        /** the nodes either side of a key on every level */
+        struct window
+        {
+            std::array<node_base *, max_level> preds;
+            std::array<node_base *, max_level> succs;
+        };
+
+        /** locks each distinct node handed to it until it goes out of scope */
+        class locks
+        {
+          public:
+            void lock(node_base *n)
+            {
+                // consecutive levels often share a predecessor
+                if (count == 0 || held[count - 1] != n)
+                {
+                    n->lock.lock();
+                    held[count++] = n;
+                }
+            }
+
+            ~locks()
+            {
+                while (count != 0)
+                {
+                    held[--count]->lock.unlock();
+                }
+            }
+
+          private:
+            std::array<node_base *, max_level + 1> held;
+            int count = 0;
+        };
+
+        static node *as_node(node_base *n) { return static_cast<node *>(n); }
+
+        static int random_level()
+        {
+            thread_local std::minstd_rand gen(std::random_device{}());
+            int level = 0;
+            while (level + 1 < max_level && (gen() & 3) == 0)
+            {
+                ++level;
+            }
+            return level;
+        }
+
+        /*
+         * fills in w for k and returns the highest level k was found on, or
+         * -1 if it was not. Must be called inside an epoch guard
+         */
+        template <typename K> int search(K const &k, window &w) const
+        {
+            int found = -1;
+            auto pred = const_cast<node_base *>(&head);
+            for (int level = max_level - 1; level >= 0; --level)
+            {
+                auto curr = pred->next[level].load();
+                while (curr != nullptr &&
+                       impl::compare_less(compare, as_node(curr)->t, k))
+                {
+                    pred = curr;
+                    curr = pred->next[level].load();
+                }
+                if (found == -1 && curr != nullptr &&
+                    !impl::compare_less(compare, k, as_node(curr)->t))
+                {
+                    found = level;
+                }
+                w.preds[level] = pred;
+                w.succs[level] = curr;
+            }
+            return found;
+        }
+
+        template <typename K> bool erase_impl(K const &k)
+        {
+            window w;
+            node_base *victim = nullptr;
+            impl::epoch::guard guard;
+
+            while (true)
+            {
+                auto const found = search(k, w);
+                if (victim == nullptr)
+                {
+                    // only a node that is fully linked and found on its top
+                    // level is in a fit state to be erased
+                    if (found == -1)
+                    {
+                        return false;
+                    }
+                    auto const n = w.succs[found];
+                    if (!n->fully_linked.load() || n->top_level != found ||
+                        n->marked.load())
+                    {
+                        return false;
+                    }
+
+                    std::lock_guard<std::mutex> lock(n->lock);
+                    if (n->marked.load())
+                    {
+                        return false;
+                    }
+                    // from here on the node is ours to unlink
+                    n->marked.store(true);
+                    victim = n;
+                }
+
+                locks held;
+                auto valid = true;
+                for (int level = 0; valid && level <= victim->top_level;
+                     ++level)
+                {
+                    auto const pred = w.preds[level];
+                    held.lock(pred);
+                    valid = !pred->marked.load() &&
+                            pred->next[level].load() == victim;
+                }
+                if (!valid)
+                {
+                    continue;
+                }
+
+                // the victim is marked so nothing links to or after it now,
+                // unlink it from the top down
+                for (int level = victim->top_level; level >= 0; --level)
+                {
+                    w.preds[level]->next[level].store(
+                        victim->next[level].load());
+                }
+                --_size;
+                impl::epoch::retire(as_node(victim));
+                return true;
+            }
+        }
+
+        template <typename K> node const *live_node(K const &k) const
+        {
+            window w;
+            auto const found = search(k, w);
+            if (found == -1)
+            {
+                return nullptr;
+            }
+            auto const n = w.succs[found];
+            return n->fully_linked.load() && !n->marked.load() ? as_node(n)
+                                                               : nullptr;
+        }
+
+        template <typename K> bool contains_impl(K const &k) const
+        {
+            impl::epoch::guard guard;
+            return live_node(k) != nullptr;
+        }
+
+        template <typename K> std::optional<T> find_impl(K const &k) const
+        {
+            impl::epoch::guard guard;
+            auto const n = live_node(k);
+            return n == nullptr ? std::nullopt : std::optional<T>(n->t);
+        }
+
+        node_base head{max_level - 1};
+        std::atomic<std::size_t> _size{0};
+        Compare compare;
+    };
+} // namespace csb
+
+#endif // CSB_CONCURRENT_SET_HPP
@@ -0,0 +1,171 @@
+#include "concurrent_set/concurrent_set.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace csb::test
+{
+    namespace
+    {
+        template <typename T> std::vector<T> values(concurrent_set<T> const &s)
+        {
+            std::vector<T> v;
+            s.for_each([&v](T const &t) { v.push_back(t); });
+            return v;
+        }
+
+        /** runs f(i) on each of n threads and waits for them all */
+        template <typename F> void on_threads(int n, F const &f)
+        {
+            std::vector<std::thread> threads;
+            for (int i = 0; i != n; ++i)
+            {
+                threads.emplace_back(f, i);
+            }
+            for (auto &t : threads)
+            {
+                t.join();
+            }
+        }
+    } // namespace
+
+    SCENARIO("concurrent set on a single thread")
+    {
+        GIVEN("a set under random adds and erases")
+        {
+            concurrent_set<int> s;
+            std::set<int> expected;
+
+            std::mt19937 gen(5);
+            std::uniform_int_distribution<> dis(0, 500);
+
+            bool results_agree = true;
+            for (int round = 0; round != 5000; ++round)
+            {
+                auto const v = dis(gen);
+                if (round % 3 == 2)
+                {
+                    results_agree = results_agree &&
+                                    s.erase(v) == (expected.erase(v) == 1);
+                }
+                else
+                {
+                    results_agree = results_agree &&
+                                    s.add(v) == expected.insert(v).second;
+                }
+            }
+
+            THEN("it agrees with std::set")
+            {
+                REQUIRE(results_agree);
+                REQUIRE(s.size() == expected.size());
+                REQUIRE(values(s) ==
+                        std::vector<int>(expected.begin(), expected.end()));
+            }
+
+            THEN("contains and find agree with std::set")
+            {
+                for (int v = -1; v != 502; ++v)
+                {
+                    auto const in = expected.count(v) == 1;
+                    REQUIRE(s.contains(v) == in);
+                    REQUIRE(s.find(v) == (in ? std::optional<int>(v)
+                                             : std::nullopt));
+                }
+            }
+        }
+
+        GIVEN("a set with a transparent comparator")
+        {
+            concurrent_set<std::string, std::less<>> s;
+            s.add("pear");
+            s.add("apple");
+
+            THEN("it can be searched without building a string")
+            {
+                REQUIRE(s.contains("pear"));
+                REQUIRE(s.find("apple") == std::string("apple"));
+                REQUIRE(s.erase("pear"));
+                REQUIRE_FALSE(s.contains("pear"));
+            }
+        }
+    }
+
+    SCENARIO("concurrent set on many threads")
+    {
+        constexpr int threads = 8;
+        constexpr int per_thread = 2000;
+
+        GIVEN("threads adding disjoint ranges and erasing half of them")
+        {
+            concurrent_set<int> s;
+            on_threads(threads, [&s](int t) {
+                for (int i = 0; i != per_thread; ++i)
+                {
+                    s.add(i * threads + t);
+                }
+                for (int i = 0; i != per_thread; i += 2)
+                {
+                    s.erase(i * threads + t);
+                }
+            });
+
+            THEN("exactly the odd rounds are left, in order")
+            {
+                std::vector<int> expected;
+                for (int i = 0; i != per_thread * threads; ++i)
+                {
+                    if ((i / threads) % 2 == 1)
+                    {
+                        expected.push_back(i);
+                    }
+                }
+                REQUIRE(values(s) == expected);
+                REQUIRE(s.size() == expected.size());
+            }
+        }
+
+        GIVEN("threads racing to add and erase the same keys")
+        {
+            concurrent_set<int> s;
+            std::atomic<int> added{0};
+            std::atomic<int> erased{0};
+
+            on_threads(threads, [&](int t) {
+                std::mt19937 gen(t);
+                std::uniform_int_distribution<> dis(0, 200);
+                for (int i = 0; i != per_thread; ++i)
+                {
+                    auto const v = dis(gen);
+                    if (i % 2 == 0)
+                    {
+                        added += s.add(v);
+                    }
+                    else
+                    {
+                        erased += s.erase(v);
+                    }
+                    // a reader on the same keys must never fall over
+                    s.contains(dis(gen));
+                }
+            });
+
+            THEN("every successful add is matched by an erase or is left")
+            {
+                auto const left = values(s);
+                REQUIRE(std::is_sorted(left.begin(), left.end()));
+                REQUIRE(std::adjacent_find(left.begin(), left.end()) ==
+                        left.end());
+                REQUIRE(static_cast<int>(left.size()) == added - erased);
+                REQUIRE(s.size() == left.size());
+            }
+        }
+    }
+} // namespace csb::test
@@ -0,0 +1,83 @@
+#ifndef CSB_COMPARE_HPP
+#define CSB_COMPARE_HPP
+
+#include <experimental/type_traits>
+#include <type_traits>
+#include <utility>
+
+#if defined(__cpp_impl_three_way_comparison) &&                               \
+    defined(__cpp_lib_three_way_comparison)
+#include <compare>
+#define CSB_HAS_SPACESHIP 1
+#endif
+
+namespace csb
+{
+    namespace impl
+    {
+        template <typename L, typename R>
+        using member_compare_t =
+            decltype(std::declval<L const &>().compare(std::declval<R>()));
+
+        template <typename Compare, typename L, typename R>
+        using compare_result_t = std::decay_t<
+            std::invoke_result_t<Compare const &, L const &, R const &>>;
+
+        /*
+         * a comparator that returns a bool is a less than. Anything else is
+         * taken to be a three way comparison, an int or an ordering, that can
+         * be compared against 0
+         */
+        template <typename Compare, typename L, typename R = L>
+        constexpr bool is_three_way_v =
+            !std::is_same_v<compare_result_t<Compare, L, R>, bool>;
+
+        /** l < r whichever kind of comparator compare is */
+        template <typename Compare, typename L, typename R>
+        bool compare_less(Compare const &compare, L const &l, R const &r)
+        {
+            if constexpr (is_three_way_v<Compare, L, R>)
+            {
+                return compare(l, r) < 0;
+            }
+            else
+            {
+                return compare(l, r);
+            }
+        }
+    } // namespace impl
+
+    /*
+     * Transparent three way comparator. Orders l against r with a single
+     * comparison where the type supports it, using operator<=> when it is
+     * available and a compare member (like std::string's) when it is not.
+     * Otherwise falls back to two calls to operator<
+     */
+    struct three_way_compare
+    {
+        using is_transparent = void;
+
+        template <typename L, typename R>
+        auto operator()(L const &l, R const &r) const
+        {
+#ifdef CSB_HAS_SPACESHIP
+            if constexpr (std::three_way_comparable_with<L, R>)
+            {
+                return l <=> r;
+            }
+            else
+#endif
+                if constexpr (std::experimental::is_detected_v<
+                                  impl::member_compare_t, L, R const &>)
+            {
+                return l.compare(r);
+            }
+            else
+            {
+                return int(r < l) - int(l < r);
+            }
+        }
+    };
+} // namespace csb
+
+#endif // CSB_COMPARE_HPP
@@ -0,0 +1,226 @@
+#ifndef CSB_EPOCH_HPP
+#define CSB_EPOCH_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace csb
+{
+    namespace impl
+    {
+        /*
+         * Epoch based reclamation. A thread holds an epoch::guard for as
+         * long as it may be looking at nodes of a concurrent structure, and
+         * a node that has been unlinked is handed to retire rather than
+         * deleted. It is only deleted once every thread that was inside a
+         * guard when it was retired has left it, so no reader can ever be
+         * left holding a dangling pointer.
+         *
+         * The global epoch only moves on once every thread inside a guard
+         * has seen its current value. A guard entered at epoch e can only
+         * have reached nodes that were still linked at e, so anything
+         * retired at e is safe to delete once the global epoch reaches e + 2.
+         *
+         * Each thread keeps its own list of retired nodes and its record in
+         * the registry is reused by the next thread to start once it exits.
+         * Nodes a thread leaves behind are passed on to whichever thread
+         * next gets to them. Like node_pool, the registry lives for the
+         * life of the process
+         */
+        class epoch
+        {
+          public:
+            class guard
+            {
+              public:
+                guard() { enter(); }
+                ~guard() { exit(); }
+
+                guard(guard const &) = delete;
+                guard &operator=(guard const &) = delete;
+            };
+
+            template <typename U> static void retire(U *p)
+            {
+                retire(p, [](void *q) { delete static_cast<U *>(q); });
+            }
+
+            static void retire(void *p, void (*deleter)(void *))
+            {
+                auto &self = local();
+                self.limbo.push_back(
+                    {p, deleter, registry().global.load()});
+
+                // amortise the scan of every thread over a batch of retires
+                if (self.limbo.size() % collect_interval == 0)
+                {
+                    try_advance();
+                    collect(self.limbo);
+                    collect_orphans();
+                }
+            }
+
+          private:
+            static constexpr std::size_t collect_interval = 64;
+
+            struct retired
+            {
+                void *p;
+                void (*deleter)(void *);
+                std::uint64_t epoch;
+            };
+
+            struct participant
+            {
+                // epoch << 1 | 1 while the thread is inside a guard, else 0
+                std::atomic<std::uint64_t> state{0};
+                std::atomic<bool> in_use{true};
+                participant *next = nullptr;
+
+                // only touched by the thread that owns the record
+                unsigned depth = 0;
+                std::vector<retired> limbo;
+            };
+
+            struct registry_type
+            {
+                std::atomic<participant *> head{nullptr};
+                std::atomic<std::uint64_t> global{0};
+                std::mutex orphan_mutex;
+                std::vector<retired> orphans;
+            };
+
+            static registry_type &registry()
+            {
+                // leaked on purpose, threads exiting during static
+                // destruction still need somewhere to leave their nodes
+                static auto *r = new registry_type();
+                return *r;
+            }
+
+            struct thread_handle
+            {
+                participant *p;
+
+                ~thread_handle()
+                {
+                    auto &r = registry();
+                    {
+                        std::lock_guard<std::mutex> lock(r.orphan_mutex);
+                        r.orphans.insert(r.orphans.end(), p->limbo.begin(),
+                                         p->limbo.end());
+                    }
+                    p->limbo.clear();
+                    p->state.store(0);
+                    p->in_use.store(false, std::memory_order_release);
+                }
+            };
+
+            static participant &local()
+            {
+                thread_local thread_handle handle{join()};
+                return *handle.p;
+            }
+
+            /** claim the record of a thread that has exited or add one */
+            static participant *join()
+            {
+                auto &r = registry();
+                for (auto p = r.head.load(); p != nullptr; p = p->next)
+                {
+                    auto expected = false;
+                    if (p->in_use.compare_exchange_strong(expected, true))
+                    {
+                        return p;
+                    }
+                }
+
+                auto p = new participant();
+                p->next = r.head.load();
+                while (!r.head.compare_exchange_weak(p->next, p))
+                {
+                }
+                return p;
+            }
+
+            static void enter()
+            {
+                auto &self = local();
+                if (self.depth++ == 0)
+                {
+                    auto const e = registry().global.load();
+                    self.state.store(e << 1 | 1);
+                    // the announcement has to be visible before any node is
+                    // read under the guard
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                }
+            }
+
+            static void exit()
+            {
+                auto &self = local();
+                if (--self.depth == 0)
+                {
+                    self.state.store(0, std::memory_order_release);
+                }
+            }
+
+            static void try_advance()
+            {
+                auto &r = registry();
+                auto e = r.global.load();
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                for (auto p = r.head.load(); p != nullptr; p = p->next)
+                {
+                    auto const s = p->state.load();
+                    if ((s & 1) != 0 && (s >> 1) != e)
+                    {
+                        return;
+                    }
+                }
+                r.global.compare_exchange_strong(e, e + 1);
+            }
+
+            /** delete everything in limbo that no guard can still see */
+            static void collect(std::vector<retired> &limbo)
+            {
+                auto const e = registry().global.load();
+                auto const keep = std::partition(
+                    limbo.begin(), limbo.end(),
+                    [e](retired const &r) { return r.epoch + 2 > e; });
+                for (auto it = keep; it != limbo.end(); ++it)
+                {
+                    it->deleter(it->p);
+                }
+                limbo.erase(keep, limbo.end());
+            }
+
+            static void collect_orphans()
+            {
+                auto &r = registry();
+                std::unique_lock<std::mutex> lock(r.orphan_mutex,
+                                                  std::try_to_lock);
+                if (lock.owns_lock() && !r.orphans.empty())
+                {
+                    std::vector<retired> orphans;
+                    std::swap(orphans, r.orphans);
+                    lock.unlock();
+
+                    collect(orphans);
+
+                    lock.lock();
+                    r.orphans.insert(r.orphans.end(), orphans.begin(),
+                                     orphans.end());
+                }
+            }
+        };
+    } // namespace impl
+} // namespace csb
+
+#endif // CSB_EPOCH_HPP
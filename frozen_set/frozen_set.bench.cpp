@@ -0,0 +1,92 @@
+#include "frozen_set/frozen_set.hpp"
+#include "red_black_tree/red_black_tree.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace csb::bench
+{
+    namespace
+    {
+        constexpr int lookups = 100000;
+
+        std::vector<int> probes(int n)
+        {
+            std::mt19937 gen(13);
+            std::uniform_int_distribution<int> dis(0, 2 * n - 1);
+            std::vector<int> p;
+            for (int i = 0; i != lookups; ++i)
+            {
+                p.push_back(dis(gen));
+            }
+            return p;
+        }
+
+        template <typename Set>
+        int count_found(Set const &set, std::vector<int> const &p)
+        {
+            int found = 0;
+            for (auto k : p)
+            {
+                found += set.contains(k);
+            }
+            return found;
+        }
+    } // namespace
+
+    TEST_CASE("frozen_set vs red_black_tree and a sorted array", "[benchmark]")
+    {
+        for (int n : {1000, 1000000, 10000000})
+        {
+            // the even numbers below 2n, added in a random order
+            std::vector<int> keys;
+            for (int i = 0; i != n; ++i)
+            {
+                keys.push_back(2 * i);
+            }
+            std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+
+            red_black_tree<int> rb;
+            for (auto k : keys)
+            {
+                rb.add(k);
+            }
+            frozen_set<int> const fs(rb);
+            std::vector<int> const sorted(rb.begin(), rb.end());
+
+            auto const p = probes(n);
+            auto const suffix = ", " + std::to_string(n) + " keys";
+
+            std::cout << n << " keys: red_black_tree "
+                      << sizeof(red_black_tree<int>::node_type) * n
+                      << " bytes of nodes, frozen_set "
+                      << sizeof(int) * fs.size() << " bytes\n";
+
+            BENCHMARK("red_black_tree 100K contains" + suffix)
+            {
+                return count_found(rb, p);
+            };
+
+            BENCHMARK("std::binary_search 100K contains" + suffix)
+            {
+                int found = 0;
+                for (auto k : p)
+                {
+                    found +=
+                        std::binary_search(sorted.begin(), sorted.end(), k);
+                }
+                return found;
+            };
+
+            BENCHMARK("frozen_set 100K contains" + suffix)
+            {
+                return count_found(fs, p);
+            };
+        }
+    }
+} // namespace csb::bench
@@ -0,0 +1,409 @@
+#ifndef CSB_FROZEN_SET_HPP
+#define CSB_FROZEN_SET_HPP
+
+#include <binary_tree/binary_tree.hpp>
+#include <core/compare.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace csb
+{
+    template <typename T, typename Compare = std::less<T>> class frozen_set;
+
+    namespace impl
+    {
+        /** the number of low bits of k that are set */
+        inline std::size_t trailing_ones(std::size_t k)
+        {
+#if defined(__GNUC__)
+            return ~k == 0 ? sizeof(k) * 8
+                           : static_cast<std::size_t>(__builtin_ctzll(~k));
+#else
+            std::size_t n = 0;
+            for (; k & 1; k >>= 1)
+            {
+                ++n;
+            }
+            return n;
+#endif
+        }
+
+        /** the number of low bits of k that are clear, k must not be 0 */
+        inline std::size_t trailing_zeros(std::size_t k)
+        {
+            return trailing_ones(~k);
+        }
+
+        /*
+         * The positions are 1 based so that the children of k are 2k and
+         * 2k + 1 and its parent is k / 2, position 0 is end(). In order the
+         * successor of k is the leftmost node of its right subtree if it
+         * has one, otherwise the first ancestor it is in the left subtree
+         * of. Stepping up past every ancestor k is the right child of and
+         * then one more is a shift by its trailing ones plus one
+         */
+        template <typename T> class frozen_set_iterator
+        {
+          public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = value_type const *;
+            using reference = value_type const &;
+
+            frozen_set_iterator &operator++()
+            {
+                if (2 * k + 1 <= n)
+                {
+                    k = 2 * k + 1;
+                    while (2 * k <= n)
+                    {
+                        k = 2 * k;
+                    }
+                }
+                else
+                {
+                    k >>= trailing_ones(k) + 1;
+                }
+                return *this;
+            }
+
+            frozen_set_iterator operator++(int)
+            {
+                auto cpy = *this;
+                ++(*this);
+                return cpy;
+            }
+
+            frozen_set_iterator &operator--()
+            {
+                if (k == 0 || 2 * k <= n)
+                {
+                    // the rightmost node of the whole tree or of the left
+                    // subtree
+                    k = k == 0 ? 1 : 2 * k;
+                    while (2 * k + 1 <= n)
+                    {
+                        k = 2 * k + 1;
+                    }
+                }
+                else
+                {
+                    k >>= trailing_zeros(k) + 1;
+                }
+                return *this;
+            }
+
+            frozen_set_iterator operator--(int)
+            {
+                auto tmp = *this;
+                --(*this);
+                return tmp;
+            }
+
+            reference operator*() const { return keys[k - 1]; }
+
+            pointer operator->() const { return &keys[k - 1]; }
+
+          private:
+            frozen_set_iterator(T const *keys, std::size_t n, std::size_t k)
+                  : keys(keys), n(n), k(k)
+            {
+            }
+
+            T const *keys = nullptr;
+            std::size_t n = 0;
+            std::size_t k = 0;
+
+            template <typename U, typename C> friend class csb::frozen_set;
+
+            friend bool operator==(frozen_set_iterator const &l,
+                                   frozen_set_iterator const &r)
+            {
+                return l.k == r.k;
+            }
+
+            friend bool operator!=(frozen_set_iterator const &l,
+                                   frozen_set_iterator const &r)
+            {
+                return !(l == r);
+            }
+        };
+    } // namespace impl
+
+    /*
+     * A read only ordered set for when the elements are known up front and
+     * then searched over and over. The elements sit in one array in
+     * Eytzinger order, the order a breadth first traversal of a perfectly
+     * balanced tree would visit them in: the root first, then both of its
+     * children, then all four grandchildren and so on. The children of the
+     * element at k are at 2k and 2k + 1, so the tree needs no pointers and
+     * the array is all the memory it takes.
+     *
+     * A search goes down the levels with k = 2k + (element < key), with no
+     * branch to mispredict. The descendants a few levels below an element
+     * are next to each other, so it prefetches the cache line holding them
+     * and its later misses overlap. Iterators still visit the elements in
+     * Compare order
+     */
+    template <typename T, typename Compare> class frozen_set
+    {
+      public:
+        static_assert(std::is_invocable_v<Compare const &, T const &,
+                                          T const &>,
+                      "Compare must be able to order two Ts in order for "
+                      "frozen_set to function properly");
+
+        using value_type = T;
+        using key_compare = Compare;
+        using const_iterator = impl::frozen_set_iterator<T>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        frozen_set() = default;
+
+        explicit frozen_set(Compare const &compare) : compare(compare) {}
+
+        /*
+         * copies the elements of a tree ordered by the same Compare, taking
+         * the tree's comparator along with the order it put them in
+         */
+        template <typename BP, typename AP>
+        explicit frozen_set(binary_tree<T, BP, AP, Compare> const &tree)
+              : frozen_set(
+                    from_sorted(tree.begin(), tree.end(), tree.key_comp()))
+        {
+        }
+
+        /*
+         * builds the set from a sorted range of unique elements in O(n).
+         * Pass move iterators to move the elements in
+         */
+        template <typename Iter>
+        static frozen_set from_sorted(Iter first, Iter last,
+                                      Compare const &compare = Compare())
+        {
+            frozen_set fs(compare);
+            auto const n = static_cast<std::size_t>(std::distance(first, last));
+            fs.keys.resize(n);
+            fs.place(first, 1);
+            return fs;
+        }
+
+        friend bool operator==(frozen_set const &l, frozen_set const &r)
+        {
+            // the layout only depends on the size, so equal sets have equal
+            // arrays
+            return l.keys == r.keys;
+        }
+
+        friend bool operator!=(frozen_set const &l, frozen_set const &r)
+        {
+            return !(l == r);
+        }
+
+        bool contains(T const &t) const { return find(t) != end(); }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        bool contains(K const &k) const
+        {
+            return find(k) != end();
+        }
+
+        const_iterator find(T const &t) const { return find_impl(t); }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        const_iterator find(K const &k) const
+        {
+            return find_impl(k);
+        }
+
+        /** the first element not less than t, or end() if there is none */
+        const_iterator lower_bound(T const &t) const
+        {
+            return at(search<false>(t));
+        }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        const_iterator lower_bound(K const &k) const
+        {
+            return at(search<false>(k));
+        }
+
+        /** the first element greater than t, or end() if there is none */
+        const_iterator upper_bound(T const &t) const
+        {
+            return at(search<true>(t));
+        }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        const_iterator upper_bound(K const &k) const
+        {
+            return at(search<true>(k));
+        }
+
+        /*
+         * the position of it in sorted order, the number of elements less
+         * than *it, or size() for end(). O(log² n), it sums the sizes of
+         * the left subtrees along the path from the root
+         */
+        std::size_t rank(const_iterator it) const
+        {
+            auto k = it.k;
+            if (k == 0)
+            {
+                return size();
+            }
+
+            auto r = subtree_size(2 * k);
+            for (; k != 1; k /= 2)
+            {
+                if (k % 2 == 1)
+                {
+                    r += subtree_size(k - 1) + 1;
+                }
+            }
+            return r;
+        }
+
+        std::size_t size() const { return keys.size(); }
+
+        bool is_empty() const { return keys.empty(); }
+
+        key_compare key_comp() const { return compare; }
+
+        const_iterator begin() const
+        {
+            if (keys.empty())
+            {
+                return end();
+            }
+            std::size_t k = 1;
+            while (2 * k <= size())
+            {
+                k = 2 * k;
+            }
+            return at(k);
+        }
+
+        const_iterator end() const { return at(0); }
+
+        const_reverse_iterator rbegin() const
+        {
+            return const_reverse_iterator(end());
+        }
+
+        const_reverse_iterator rend() const
+        {
+            return const_reverse_iterator(begin());
+        }
+
+      private:
+        /*
+         * how many descendants, a power of two levels down, fit in a cache
+         * line. 16 for 4 byte keys
+         */
+        static constexpr std::size_t prefetch_stride()
+        {
+            std::size_t stride = 1;
+            while (2 * stride * sizeof(T) <= 64)
+            {
+                stride *= 2;
+            }
+            return stride;
+        }
+
+        const_iterator at(std::size_t k) const
+        {
+            return {keys.data(), keys.size(), k};
+        }
+
+        /** fills in the subtree at k from an in order walk of the range */
+        template <typename Iter> Iter place(Iter it, std::size_t k)
+        {
+            if (k <= keys.size())
+            {
+                it = place(it, 2 * k);
+                keys[k - 1] = *it;
+                ++it;
+                it = place(it, 2 * k + 1);
+            }
+            return it;
+        }
+
+        /** the number of positions in the subtree at k */
+        std::size_t subtree_size(std::size_t k) const
+        {
+            std::size_t count = 0;
+            for (std::size_t first = k, last = k; first <= size();
+                 first = 2 * first, last = 2 * last + 1)
+            {
+                count += std::min(last, size()) - first + 1;
+            }
+            return count;
+        }
+
+        /*
+         * the position of the first element not less than k, or with
+         * Upper the first greater than k, 0 if there is none.
+         *
+         * The loop walks down to below a leaf, each step going right when
+         * the element is less than k. The answer is the last place it went
+         * left, so the right turns it took after that, which are the
+         * trailing ones of the final position, are shifted back off
+         */
+        template <bool Upper, typename K> std::size_t search(K const &k) const
+        {
+            auto const n = keys.size();
+            std::size_t i = 1;
+            while (i <= n)
+            {
+#if defined(__GNUC__)
+                // may be past the end of the array, which is harmless for a
+                // prefetch as long as the address is not formed from a
+                // pointer
+                __builtin_prefetch(reinterpret_cast<void const *>(
+                    reinterpret_cast<std::uintptr_t>(keys.data()) +
+                    (prefetch_stride() * i - 1) * sizeof(T)));
+#endif
+                auto const &e = keys[i - 1];
+                bool right;
+                if constexpr (Upper)
+                {
+                    right = !impl::compare_less(compare, k, e);
+                }
+                else
+                {
+                    right = impl::compare_less(compare, e, k);
+                }
+                i = 2 * i + right;
+            }
+            return i >> (impl::trailing_ones(i) + 1);
+        }
+
+        template <typename K> const_iterator find_impl(K const &k) const
+        {
+            auto const i = search<false>(k);
+            if (i == 0 || impl::compare_less(compare, k, keys[i - 1]))
+            {
+                return end();
+            }
+            return at(i);
+        }
+
+        std::vector<T> keys;
+        Compare compare;
+    };
+} // namespace csb
+
+#endif // CSB_FROZEN_SET_HPP
@@ -0,0 +1,141 @@
+#include "frozen_set/frozen_set.hpp"
+#include "red_black_tree/red_black_tree.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace csb::test
+{
+    SCENARIO("frozen set searches like a sorted array")
+    {
+        GIVEN("frozen sets of every size from empty to a few full levels")
+        {
+            THEN("iteration, bounds and ranks agree with the sorted array")
+            {
+                for (int n = 0; n != 70; ++n)
+                {
+                    // odd numbers so every even probe falls between two
+                    std::vector<int> sorted;
+                    for (int i = 0; i != n; ++i)
+                    {
+                        sorted.push_back(2 * i + 1);
+                    }
+                    auto const fs = frozen_set<int>::from_sorted(sorted.begin(),
+                                                                 sorted.end());
+
+                    REQUIRE(fs.size() == sorted.size());
+                    REQUIRE(std::vector<int>(fs.begin(), fs.end()) == sorted);
+                    REQUIRE(std::vector<int>(fs.rbegin(), fs.rend()) ==
+                            std::vector<int>(sorted.rbegin(), sorted.rend()));
+
+                    for (int probe = -1; probe <= 2 * n + 1; ++probe)
+                    {
+                        auto const lb = static_cast<std::size_t>(
+                            std::lower_bound(sorted.begin(), sorted.end(),
+                                             probe) -
+                            sorted.begin());
+                        auto const ub = static_cast<std::size_t>(
+                            std::upper_bound(sorted.begin(), sorted.end(),
+                                             probe) -
+                            sorted.begin());
+
+                        REQUIRE(fs.rank(fs.lower_bound(probe)) == lb);
+                        REQUIRE(fs.rank(fs.upper_bound(probe)) == ub);
+                        REQUIRE(fs.contains(probe) == (lb != ub));
+                    }
+                }
+            }
+        }
+    }
+
+    namespace
+    {
+        // a comparator with state, either ascending or descending
+        struct by_dir
+        {
+            bool descending = false;
+
+            bool operator()(int l, int r) const
+            {
+                return descending ? r < l : l < r;
+            }
+        };
+    } // namespace
+
+    SCENARIO("frozen set built from a tree")
+    {
+        GIVEN("a red black tree of random values")
+        {
+            red_black_tree<int> rb;
+            std::mt19937 gen(22);
+            std::uniform_int_distribution<> dis(0, 100000);
+            for (int i = 0; i != 5000; ++i)
+            {
+                rb.add(dis(gen));
+            }
+
+            WHEN("it is frozen")
+            {
+                frozen_set<int> const fs(rb);
+
+                THEN("it holds the same elements in the same order")
+                {
+                    REQUIRE(fs.size() == rb.size());
+                    REQUIRE(std::equal(fs.begin(), fs.end(), rb.begin(),
+                                       rb.end()));
+                }
+
+                THEN("finds agree with the tree")
+                {
+                    for (int v = 0; v < 100000; v += 7)
+                    {
+                        REQUIRE(fs.contains(v) == rb.contains(v));
+                    }
+                }
+            }
+        }
+
+        GIVEN("a tree ordered by a comparator with state")
+        {
+            red_black_tree<int, by_dir> rb(by_dir{true});
+            for (int i = 0; i != 100; ++i)
+            {
+                rb.add(i * 37 % 100);
+            }
+            frozen_set<int, by_dir> const fs(rb);
+
+            THEN("it searches with the tree's comparator")
+            {
+                REQUIRE(fs.key_comp().descending);
+                REQUIRE(*fs.begin() == 99);
+                REQUIRE(std::equal(fs.begin(), fs.end(), rb.begin(),
+                                   rb.end()));
+                for (int v = -5; v != 105; ++v)
+                {
+                    REQUIRE(fs.contains(v) == rb.contains(v));
+                }
+                REQUIRE(*fs.lower_bound(50) == 50);
+                REQUIRE(*fs.upper_bound(50) == 49);
+            }
+        }
+
+        GIVEN("a tree of strings with a transparent comparator")
+        {
+            red_black_tree<std::string, std::less<>> rb{"pear", "apple",
+                                                        "fig"};
+            frozen_set<std::string, std::less<>> const fs(rb);
+
+            THEN("it can be searched without building a string")
+            {
+                REQUIRE(fs.contains("fig"));
+                REQUIRE(*fs.lower_bound("b") == "fig");
+                REQUIRE(fs.find("grape") == fs.end());
+                REQUIRE(fs.rank(fs.find("pear")) == 2);
+            }
+        }
+    }
+} // namespace csb::test
@@ -0,0 +1,521 @@
+#ifndef CSB_PERSISTENT_RED_BLACK_TREE_HPP
+#define CSB_PERSISTENT_RED_BLACK_TREE_HPP
+
+#include "red_black_tree.hpp"
+
+#include <core/compare.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace csb
+{
+    template <typename T, typename Compare = std::less<T>>
+    class persistent_red_black_tree;
+
+    namespace impl
+    {
+        /*
+         * a node of a persistent_red_black_tree. Nodes are never changed
+         * once built and can be shared by any number of versions of a tree,
+         * so they have no parent pointer and are owned by reference count
+         */
+        template <typename T> struct persistent_node
+        {
+            using value_type = T;
+            using pointer = std::shared_ptr<persistent_node const>;
+
+            T t;
+            pointer left;
+            pointer right;
+            Colour colour;
+        };
+
+        template <typename Node> class persistent_tree_iterator
+        {
+          public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = typename Node::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = value_type const *;
+            using reference = value_type const &;
+
+            persistent_tree_iterator() = default;
+
+            persistent_tree_iterator &operator++()
+            {
+                auto const n = path.back();
+                path.pop_back();
+                descend_left(n->right.get());
+                return *this;
+            }
+
+            persistent_tree_iterator operator++(int)
+            {
+                auto cpy = *this;
+                ++(*this);
+                return cpy;
+            }
+
+            reference operator*() const { return path.back()->t; }
+
+            pointer operator->() const { return &path.back()->t; }
+
+          private:
+            // with no parent pointers to climb, the iterator keeps the
+            // ancestors still to be visited. The back is the current node
+            std::vector<Node const *> path;
+
+            void descend_left(Node const *n)
+            {
+                for (; n != nullptr; n = n->left.get())
+                {
+                    path.push_back(n);
+                }
+            }
+
+            template <typename T, typename C>
+            friend class csb::persistent_red_black_tree;
+
+            friend bool operator==(persistent_tree_iterator const &l,
+                                   persistent_tree_iterator const &r)
+            {
+                return l.path.empty() ? r.path.empty()
+                                      : !r.path.empty() &&
+                                            l.path.back() == r.path.back();
+            }
+
+            friend bool operator!=(persistent_tree_iterator const &l,
+                                   persistent_tree_iterator const &r)
+            {
+                return !(l == r);
+            }
+        };
+    } // namespace impl
+
+    /*
+     * A red black tree whose nodes are never modified. add and erase copy
+     * the O(log n) nodes on the path to the change and share every other
+     * node with the version before, so snapshot() is just a copy of the
+     * root pointer. A snapshot never changes whatever happens to the tree
+     * it was taken from afterwards, so it can be read on other threads with
+     * no locking at all. Handing a snapshot over to another thread still
+     * needs a happens-before, such as std::atomic_store of a shared_ptr to
+     * it, but nothing more.
+     *
+     * The balancing follows Kahrs' functional red black trees: insertion
+     * rebalances on the way back up with Okasaki's four cases and deletion
+     * fuses the two subtrees of the removed node
+     */
+    template <typename T, typename Compare> class persistent_red_black_tree
+    {
+      public:
+        static_assert(std::is_copy_constructible_v<T>,
+                      "path copying copies elements, so T must be copyable");
+
+        using value_type = T;
+        using node_type = impl::persistent_node<T>;
+        using const_iterator = impl::persistent_tree_iterator<node_type>;
+        using key_compare = Compare;
+
+        persistent_red_black_tree() = default;
+
+        explicit persistent_red_black_tree(Compare const &compare)
+              : compare(compare)
+        {
+        }
+
+        /*implicit*/ persistent_red_black_tree(std::initializer_list<T> list)
+        {
+            for (auto const &e : list)
+            {
+                add(e);
+            }
+        }
+
+        friend bool operator==(persistent_red_black_tree const &l,
+                               persistent_red_black_tree const &r)
+        {
+            return l.size() == r.size() &&
+                   std::equal(l.begin(), l.end(), r.begin());
+        }
+
+        friend bool operator!=(persistent_red_black_tree const &l,
+                               persistent_red_black_tree const &r)
+        {
+            return !(l == r);
+        }
+
+        /** an immutable copy of the tree as it is now, O(1) */
+        persistent_red_black_tree snapshot() const { return *this; }
+
+        /** O(log n) time and new nodes, nothing is copied if t is present */
+        void add(T t)
+        {
+            if (contains(t))
+            {
+                return;
+            }
+            root = blacken(insert_node(root, std::move(t)));
+            ++_size;
+        }
+
+        void erase(T const &t) { erase_impl(t); }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        void erase(K const &k)
+        {
+            erase_impl(k);
+        }
+
+        bool contains(T const &t) const { return find_node(t) != nullptr; }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        bool contains(K const &k) const
+        {
+            return find_node(k) != nullptr;
+        }
+
+        const_iterator find(T const &t) const { return find_impl(t); }
+
+        template <typename K, typename C = Compare,
+                  typename = typename C::is_transparent>
+        const_iterator find(K const &k) const
+        {
+            return find_impl(k);
+        }
+
+        template <typename Callable>
+        void inorder_traverse(Callable const &visiter) const
+        {
+            for (auto const &e : *this)
+            {
+                visiter(e);
+            }
+        }
+
+        template <typename Callable>
+        void breadth_first_traverse_nodes(Callable const &visiter) const
+        {
+            if (root == nullptr)
+            {
+                return;
+            }
+
+            std::queue<node_type const *> q;
+            q.push(root.get());
+
+            while (!q.empty())
+            {
+                auto n = q.front();
+                q.pop();
+
+                visiter(*n);
+                if (n->left != nullptr)
+                {
+                    q.push(n->left.get());
+                }
+                if (n->right != nullptr)
+                {
+                    q.push(n->right.get());
+                }
+            }
+        }
+
+        bool is_empty() const { return root == nullptr; }
+
+        std::size_t size() const { return _size; }
+
+        const_iterator begin() const
+        {
+            const_iterator it;
+            it.descend_left(root.get());
+            return it;
+        }
+
+        const_iterator end() const { return const_iterator(); }
+
+      private:
+        using pointer = typename node_type::pointer;
+        using Colour = impl::Colour;
+
+        static pointer make(Colour colour, pointer left, T t, pointer right)
+        {
+            return std::make_shared<node_type const>(node_type{
+                std::move(t), std::move(left), std::move(right), colour});
+        }
+
+        static bool is_red(pointer const &n)
+        {
+            return n != nullptr && n->colour == Colour::Red;
+        }
+
+        static bool is_black(pointer const &n)
+        {
+            return n != nullptr && n->colour == Colour::Black;
+        }
+
+        static pointer paint(pointer const &n, Colour colour)
+        {
+            return n->colour == colour
+                       ? n
+                       : make(colour, n->left, n->t, n->right);
+        }
+
+        static pointer blacken(pointer const &n)
+        {
+            return n == nullptr ? n : paint(n, Colour::Black);
+        }
+
+        /*
+         * rebuilds a black node from left, t and right, rotating away a red
+         * child with a red child of its own on either side
+         */
+        static pointer balance(pointer const &left, T const &t,
+                               pointer const &right)
+        {
+            auto const B = Colour::Black;
+            auto const R = Colour::Red;
+
+            if (is_red(left) && is_red(right))
+            {
+                return make(R, paint(left, B), t, paint(right, B));
+            }
+            if (is_red(left) && is_red(left->left))
+            {
+                return make(R, paint(left->left, B), left->t,
+                            make(B, left->right, t, right));
+            }
+            if (is_red(left) && is_red(left->right))
+            {
+                auto const &lr = left->right;
+                return make(R, make(B, left->left, left->t, lr->left), lr->t,
+                            make(B, lr->right, t, right));
+            }
+            if (is_red(right) && is_red(right->right))
+            {
+                return make(R, make(B, left, t, right->left), right->t,
+                            paint(right->right, B));
+            }
+            if (is_red(right) && is_red(right->left))
+            {
+                auto const &rl = right->left;
+                return make(R, make(B, left, t, rl->left), rl->t,
+                            make(B, rl->right, right->t, right->right));
+            }
+            return make(B, left, t, right);
+        }
+
+        /** t is known not to be in the tree under n */
+        pointer insert_node(pointer const &n, T t) const
+        {
+            if (n == nullptr)
+            {
+                return make(Colour::Red, nullptr, std::move(t), nullptr);
+            }
+
+            if (impl::compare_less(compare, t, n->t))
+            {
+                auto left = insert_node(n->left, std::move(t));
+                return n->colour == Colour::Black
+                           ? balance(left, n->t, n->right)
+                           : make(Colour::Red, left, n->t, n->right);
+            }
+
+            auto right = insert_node(n->right, std::move(t));
+            return n->colour == Colour::Black
+                       ? balance(n->left, n->t, right)
+                       : make(Colour::Red, n->left, n->t, right);
+        }
+
+        template <typename K> void erase_impl(K const &k)
+        {
+            if (!contains(k))
+            {
+                return;
+            }
+            root = blacken(erase_node(root, k));
+            --_size;
+        }
+
+        /*
+         * k is known to be in the tree under n. Erasing from under a black
+         * node shortens that side by one black node, which balance_left and
+         * balance_right then make up for
+         */
+        template <typename K>
+        pointer erase_node(pointer const &n, K const &k) const
+        {
+            if (impl::compare_less(compare, k, n->t))
+            {
+                auto left = erase_node(n->left, k);
+                return is_black(n->left)
+                           ? balance_left(left, n->t, n->right)
+                           : make(Colour::Red, left, n->t, n->right);
+            }
+            if (impl::compare_less(compare, n->t, k))
+            {
+                auto right = erase_node(n->right, k);
+                return is_black(n->right)
+                           ? balance_right(n->left, n->t, right)
+                           : make(Colour::Red, n->left, n->t, right);
+            }
+            return fuse(n->left, n->right);
+        }
+
+        /** left is one black node shorter than right */
+        static pointer balance_left(pointer const &left, T const &t,
+                                    pointer const &right)
+        {
+            auto const B = Colour::Black;
+            auto const R = Colour::Red;
+
+            if (is_red(left))
+            {
+                return make(R, paint(left, B), t, right);
+            }
+            if (is_black(right))
+            {
+                return balance(left, t, paint(right, R));
+            }
+
+            assert(is_red(right) && is_black(right->left));
+            auto const &rl = right->left;
+            return make(R, make(B, left, t, rl->left), rl->t,
+                        balance(rl->right, right->t,
+                                paint(right->right, R)));
+        }
+
+        /** right is one black node shorter than left */
+        static pointer balance_right(pointer const &left, T const &t,
+                                     pointer const &right)
+        {
+            auto const B = Colour::Black;
+            auto const R = Colour::Red;
+
+            if (is_red(right))
+            {
+                return make(R, left, t, paint(right, B));
+            }
+            if (is_black(left))
+            {
+                return balance(paint(left, R), t, right);
+            }
+
+            assert(is_red(left) && is_black(left->right));
+            auto const &lr = left->right;
+            return make(R,
+                        balance(paint(left->left, R), left->t, lr->left),
+                        lr->t, make(B, lr->right, t, right));
+        }
+
+        /** joins the two subtrees of an erased node */
+        static pointer fuse(pointer const &left, pointer const &right)
+        {
+            auto const B = Colour::Black;
+            auto const R = Colour::Red;
+
+            if (left == nullptr)
+            {
+                return right;
+            }
+            if (right == nullptr)
+            {
+                return left;
+            }
+
+            if (is_red(left) && is_red(right))
+            {
+                auto const mid = fuse(left->right, right->left);
+                if (is_red(mid))
+                {
+                    return make(R, make(R, left->left, left->t, mid->left),
+                                mid->t,
+                                make(R, mid->right, right->t, right->right));
+                }
+                return make(R, left->left, left->t,
+                            make(R, mid, right->t, right->right));
+            }
+            if (is_black(left) && is_black(right))
+            {
+                auto const mid = fuse(left->right, right->left);
+                if (is_red(mid))
+                {
+                    return make(R, make(B, left->left, left->t, mid->left),
+                                mid->t,
+                                make(B, mid->right, right->t, right->right));
+                }
+                return balance_left(left->left, left->t,
+                                    make(B, mid, right->t, right->right));
+            }
+            if (is_red(right))
+            {
+                return make(R, fuse(left, right->left), right->t,
+                            right->right);
+            }
+            return make(R, left->left, left->t, fuse(left->right, right));
+        }
+
+        template <typename K> node_type const *find_node(K const &k) const
+        {
+            auto n = root.get();
+            while (n != nullptr)
+            {
+                if (impl::compare_less(compare, k, n->t))
+                {
+                    n = n->left.get();
+                }
+                else if (impl::compare_less(compare, n->t, k))
+                {
+                    n = n->right.get();
+                }
+                else
+                {
+                    return n;
+                }
+            }
+            return nullptr;
+        }
+
+        template <typename K> const_iterator find_impl(K const &k) const
+        {
+            // the iterator needs every ancestor k is to the left of
+            const_iterator it;
+            auto n = root.get();
+            while (n != nullptr)
+            {
+                if (impl::compare_less(compare, k, n->t))
+                {
+                    it.path.push_back(n);
+                    n = n->left.get();
+                }
+                else if (impl::compare_less(compare, n->t, k))
+                {
+                    n = n->right.get();
+                }
+                else
+                {
+                    it.path.push_back(n);
+                    return it;
+                }
+            }
+            return end();
+        }
+
+        pointer root = nullptr;
+        std::size_t _size = 0;
+        Compare compare;
+    };
+} // namespace csb
+
+#endif // CSB_PERSISTENT_RED_BLACK_TREE_HPP
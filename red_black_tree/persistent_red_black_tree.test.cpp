@@ -0,0 +1,237 @@
+#include "red_black_tree/persistent_red_black_tree.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace csb::test
+{
+    namespace
+    {
+        using node = impl::persistent_node<int>;
+
+        /** the black height under n, or -1 if the colours are broken */
+        int checked_black_height(node const *n)
+        {
+            if (n == nullptr)
+            {
+                return 0;
+            }
+
+            if (n->colour == impl::Colour::Red &&
+                ((n->left != nullptr &&
+                  n->left->colour == impl::Colour::Red) ||
+                 (n->right != nullptr &&
+                  n->right->colour == impl::Colour::Red)))
+            {
+                return -1;
+            }
+
+            auto const l = checked_black_height(n->left.get());
+            auto const r = checked_black_height(n->right.get());
+            if (l == -1 || l != r)
+            {
+                return -1;
+            }
+            return l + (n->colour == impl::Colour::Black ? 1 : 0);
+        }
+
+        bool is_valid(persistent_red_black_tree<int> const &tree)
+        {
+            node const *root = nullptr;
+            tree.breadth_first_traverse_nodes([&root](node const &n) {
+                if (root == nullptr)
+                {
+                    root = &n;
+                }
+            });
+            return (root == nullptr || root->colour == impl::Colour::Black) &&
+                   checked_black_height(root) != -1 &&
+                   std::is_sorted(tree.begin(), tree.end()) &&
+                   static_cast<std::size_t>(
+                       std::distance(tree.begin(), tree.end())) ==
+                       tree.size();
+        }
+
+        std::vector<int> values(persistent_red_black_tree<int> const &tree)
+        {
+            return std::vector<int>(tree.begin(), tree.end());
+        }
+    } // namespace
+
+    SCENARIO("persistent red black tree")
+    {
+        GIVEN("a tree under random inserts and erases")
+        {
+            persistent_red_black_tree<int> tree;
+            std::vector<int> expected;
+
+            std::mt19937 gen(3);
+            std::uniform_int_distribution<> dis(0, 300);
+
+            bool always_valid = true;
+            for (int round = 0; round != 3000; ++round)
+            {
+                auto const v = dis(gen);
+                auto const pos =
+                    std::lower_bound(expected.begin(), expected.end(), v);
+                auto const present = pos != expected.end() && *pos == v;
+
+                if (round % 3 == 2)
+                {
+                    tree.erase(v);
+                    if (present)
+                    {
+                        expected.erase(pos);
+                    }
+                }
+                else
+                {
+                    tree.add(v);
+                    if (!present)
+                    {
+                        expected.insert(pos, v);
+                    }
+                }
+                always_valid = always_valid && is_valid(tree);
+            }
+
+            THEN("it stays a valid red black tree")
+            {
+                REQUIRE(always_valid);
+                REQUIRE(values(tree) == expected);
+            }
+
+            THEN("find and contains agree with the elements")
+            {
+                for (int v = -1; v != 302; ++v)
+                {
+                    auto const in = std::binary_search(expected.begin(),
+                                                       expected.end(), v);
+                    REQUIRE(tree.contains(v) == in);
+                    REQUIRE((tree.find(v) != tree.end()) == in);
+                    if (in)
+                    {
+                        REQUIRE(std::equal(
+                            tree.find(v), tree.end(),
+                            std::lower_bound(expected.begin(),
+                                             expected.end(), v),
+                            expected.end()));
+                    }
+                }
+            }
+
+            WHEN("erasing everything")
+            {
+                for (auto v : expected)
+                {
+                    tree.erase(v);
+                }
+
+                THEN("it is empty")
+                {
+                    REQUIRE(tree.is_empty());
+                    REQUIRE(tree.size() == 0);
+                    REQUIRE(tree.begin() == tree.end());
+                }
+            }
+        }
+
+        GIVEN("a snapshot of a tree")
+        {
+            persistent_red_black_tree<int> tree{5, 3, 8, 1, 4};
+            auto const before = tree.snapshot();
+
+            WHEN("the tree is changed")
+            {
+                tree.add(6);
+                tree.erase(3);
+
+                THEN("the snapshot is unaffected")
+                {
+                    REQUIRE(values(before) == std::vector{1, 3, 4, 5, 8});
+                    REQUIRE(values(tree) == std::vector{1, 4, 5, 6, 8});
+                    REQUIRE(is_valid(before));
+                    REQUIRE(is_valid(tree));
+                }
+            }
+
+            WHEN("adding an element that is already there")
+            {
+                tree.add(4);
+
+                THEN("the tree still shares its root with the snapshot")
+                {
+                    node const *a = nullptr;
+                    node const *b = nullptr;
+                    tree.breadth_first_traverse_nodes(
+                        [&a](node const &n) { a = a ? a : &n; });
+                    before.breadth_first_traverse_nodes(
+                        [&b](node const &n) { b = b ? b : &n; });
+                    REQUIRE(a == b);
+                }
+            }
+        }
+
+        GIVEN("a writer publishing snapshots to readers on other threads")
+        {
+            constexpr int count = 2000;
+            auto published =
+                std::make_shared<persistent_red_black_tree<int> const>();
+            std::atomic<bool> done{false};
+            std::atomic<bool> readers_ok{true};
+
+            auto const reader = [&]() {
+                while (!done)
+                {
+                    auto const snap = std::atomic_load(&published);
+                    // every snapshot holds exactly 0 to size() - 1
+                    int next = 0;
+                    for (auto v : *snap)
+                    {
+                        if (v != next++)
+                        {
+                            readers_ok = false;
+                        }
+                    }
+                    if (static_cast<std::size_t>(next) != snap->size())
+                    {
+                        readers_ok = false;
+                    }
+                }
+            };
+
+            std::vector<std::thread> readers;
+            for (int i = 0; i != 3; ++i)
+            {
+                readers.emplace_back(reader);
+            }
+
+            persistent_red_black_tree<int> tree;
+            for (int i = 0; i != count; ++i)
+            {
+                tree.add(i);
+                std::atomic_store(
+                    &published,
+                    std::make_shared<persistent_red_black_tree<int> const>(
+                        tree.snapshot()));
+            }
+            done = true;
+            for (auto &t : readers)
+            {
+                t.join();
+            }
+
+            THEN("the readers only ever saw whole versions")
+            {
+                REQUIRE(readers_ok);
+                REQUIRE(published->size() == count);
+            }
+        }
+    }
+} // namespace csb::test
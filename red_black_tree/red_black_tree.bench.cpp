@@ -0,0 +1,504 @@
+#include "red_black_tree/persistent_red_black_tree.hpp"
+#include "red_black_tree/red_black_tree.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace csb::bench
+{
+    namespace
+    {
+        constexpr int string_tree_size = 200000;
+        constexpr int ingest_size = 1000000;
+        constexpr int large_set_size = 200000;
+        constexpr int small_set_size = 2000;
+
+        red_black_tree<int> random_set(int n, int seed)
+        {
+            std::mt19937 gen(seed);
+            std::uniform_int_distribution<int> dis(0, 10 * large_set_size);
+
+            red_black_tree<int> rb;
+            for (int i = 0; i != n; ++i)
+            {
+                rb.add(dis(gen));
+            }
+            return rb;
+        }
+
+        // long shared prefixes, like keys of a real index, make every
+        // comparison walk a good way into both strings
+        std::vector<std::string> random_strings(int n)
+        {
+            std::mt19937 gen(42);
+            std::uniform_int_distribution<int> dis(0, 25);
+
+            std::vector<std::string> strings;
+            for (int i = 0; i != n; ++i)
+            {
+                std::string s = "customer/account/";
+                for (int c = 0; c != 12; ++c)
+                {
+                    s.push_back(char('a' + dis(gen)));
+                }
+                strings.push_back(std::move(s));
+            }
+            return strings;
+        }
+
+        std::size_t comparisons = 0;
+
+        template <typename Compare> struct counting
+        {
+            template <typename L, typename R>
+            auto operator()(L const &l, R const &r) const
+            {
+                ++comparisons;
+                return Compare()(l, r);
+            }
+        };
+
+        template <typename Compare>
+        void report_comparisons(std::string const &name,
+                                std::vector<std::string> const &keys)
+        {
+            red_black_tree<std::string, counting<Compare>> rb;
+
+            comparisons = 0;
+            for (auto const &k : keys)
+            {
+                rb.add(k);
+            }
+            auto const insert_comparisons = comparisons;
+
+            comparisons = 0;
+            for (auto const &k : keys)
+            {
+                rb.contains(k);
+            }
+
+            std::cout << name << ": " << insert_comparisons
+                      << " comparisons to insert, " << comparisons
+                      << " comparisons to find " << keys.size() << " keys\n";
+        }
+
+        template <typename Compare>
+        red_black_tree<std::string, Compare>
+        make_tree(std::vector<std::string> const &keys)
+        {
+            red_black_tree<std::string, Compare> rb;
+            for (auto const &k : keys)
+            {
+                rb.add(k);
+            }
+            return rb;
+        }
+    } // namespace
+
+    TEST_CASE("less than vs three way comparison on strings", "[benchmark]")
+    {
+        auto const keys = random_strings(string_tree_size);
+
+        report_comparisons<std::less<>>("std::less", keys);
+        report_comparisons<three_way_compare>("three_way_compare", keys);
+
+        BENCHMARK("std::less insert, 200K strings")
+        {
+            return make_tree<std::less<>>(keys).size();
+        };
+
+        BENCHMARK("three_way_compare insert, 200K strings")
+        {
+            return make_tree<three_way_compare>(keys).size();
+        };
+
+        auto const less_tree = make_tree<std::less<>>(keys);
+        auto const three_way_tree = make_tree<three_way_compare>(keys);
+
+        BENCHMARK("std::less find, 200K strings")
+        {
+            std::size_t found = 0;
+            for (auto const &k : keys)
+            {
+                found += less_tree.contains(k);
+            }
+            return found;
+        };
+
+        BENCHMARK("three_way_compare find, 200K strings")
+        {
+            std::size_t found = 0;
+            for (auto const &k : keys)
+            {
+                found += three_way_tree.contains(k);
+            }
+            return found;
+        };
+    }
+
+    TEST_CASE("hinted vs unhinted insertion of increasing keys", "[benchmark]")
+    {
+        BENCHMARK("add, 1M increasing keys")
+        {
+            red_black_tree<int> rb;
+            for (int i = 0; i != ingest_size; ++i)
+            {
+                rb.add(i);
+            }
+            return rb.size();
+        };
+
+        BENCHMARK("add with end() hint, 1M increasing keys")
+        {
+            red_black_tree<int> rb;
+            for (int i = 0; i != ingest_size; ++i)
+            {
+                rb.add(rb.end(), i);
+            }
+            return rb.size();
+        };
+    }
+
+    TEST_CASE("merging vs split and join set union", "[benchmark]")
+    {
+        auto const large = random_set(large_set_size, 1);
+        auto const small = random_set(small_set_size, 2);
+
+        BENCHMARK("merge into a new tree, 200K and 2K elements")
+        {
+            red_black_tree<int> u;
+            auto l = large.begin();
+            auto s = small.begin();
+            while (l != large.end() || s != small.end())
+            {
+                if (s == small.end() || (l != large.end() && *l < *s))
+                {
+                    u.add(*l++);
+                }
+                else
+                {
+                    u.add(*s++);
+                }
+            }
+            return u.size();
+        };
+
+        BENCHMARK_ADVANCED("set_union, 200K and 2K elements")
+        (Catch::Benchmark::Chronometer meter)
+        {
+            std::vector<red_black_tree<int>> larges(meter.runs(), large);
+            std::vector<red_black_tree<int>> smalls(meter.runs(), small);
+            std::vector<red_black_tree<int>> unions(meter.runs());
+            meter.measure([&](int run) {
+                unions[run] = red_black_tree<int>::set_union(
+                    std::move(larges[run]), std::move(smalls[run]));
+            });
+        };
+    }
+
+    TEST_CASE("re-adding vs structural copy", "[benchmark]")
+    {
+        auto const rb = random_set(ingest_size, 3);
+
+        BENCHMARK("breadth first re-add, 800K elements")
+        {
+            red_black_tree<int> copy;
+            rb.breadth_first_traverse([&copy](int i) { copy.add(i); });
+            return copy.size();
+        };
+
+        BENCHMARK("copy constructor, 800K elements")
+        {
+            return red_black_tree<int>(rb).size();
+        };
+
+        pooled_red_black_tree<int> pooled;
+        for (auto i : rb)
+        {
+            pooled.add(i);
+        }
+
+        BENCHMARK("pooled copy constructor, 800K elements")
+        {
+            return pooled_red_black_tree<int>(pooled).size();
+        };
+    }
+
+    TEST_CASE("draining a red black tree smallest first", "[benchmark]")
+    {
+        auto const rb = random_set(large_set_size, 4);
+
+        BENCHMARK_ADVANCED("erase(*begin()), 200K elements")
+        (Catch::Benchmark::Chronometer meter)
+        {
+            std::vector<red_black_tree<int>> queues(meter.runs(), rb);
+            meter.measure([&](int run) {
+                auto &q = queues[run];
+                long sum = 0;
+                while (!q.is_empty())
+                {
+                    auto const smallest = *q.begin();
+                    sum += smallest;
+                    q.erase(smallest);
+                }
+                return sum;
+            });
+        };
+
+        BENCHMARK_ADVANCED("pop_min(), 200K elements")
+        (Catch::Benchmark::Chronometer meter)
+        {
+            std::vector<red_black_tree<int>> queues(meter.runs(), rb);
+            meter.measure([&](int run) {
+                auto &q = queues[run];
+                long sum = 0;
+                while (!q.is_empty())
+                {
+                    sum += q.pop_min();
+                }
+                return sum;
+            });
+        };
+    }
+
+    TEST_CASE("in order scan of a plain vs threaded tree", "[benchmark]")
+    {
+        auto const rb = random_set(ingest_size, 5);
+
+        // added in the same random order so both trees' nodes are spread
+        // over the heap in the same way
+        threaded_red_black_tree<int> threaded;
+        std::mt19937 gen(5);
+        std::uniform_int_distribution<int> dis(0, 10 * large_set_size);
+        for (int i = 0; i != ingest_size; ++i)
+        {
+            threaded.add(dis(gen));
+        }
+
+        BENCHMARK("plain forward scan, 800K elements")
+        {
+            return std::accumulate(rb.begin(), rb.end(), 0L);
+        };
+
+        BENCHMARK("threaded forward scan, 800K elements")
+        {
+            return std::accumulate(threaded.begin(), threaded.end(), 0L);
+        };
+
+        BENCHMARK("plain reverse scan, 800K elements")
+        {
+            return std::accumulate(rb.rbegin(), rb.rend(), 0L);
+        };
+
+        BENCHMARK("threaded reverse scan, 800K elements")
+        {
+            return std::accumulate(threaded.rbegin(), threaded.rend(), 0L);
+        };
+    }
+
+    TEST_CASE("sequential vs parallel sum", "[benchmark]")
+    {
+        auto const rb = random_set(ingest_size, 6);
+
+        BENCHMARK("inorder_traverse sum, 800K elements")
+        {
+            long sum = 0;
+            rb.inorder_traverse([&sum](int i) { sum += i; });
+            return sum;
+        };
+
+        BENCHMARK("parallel_reduce sum, 800K elements")
+        {
+            return rb.parallel_reduce(
+                0L, [](long acc, int i) { return acc + i; }, std::plus<>());
+        };
+    }
+
+    TEST_CASE("sequential vs parallel bulk construction", "[benchmark]")
+    {
+        std::mt19937 gen(7);
+        std::uniform_int_distribution<int> dis(0, 10 * ingest_size);
+        std::vector<int> keys;
+        for (int i = 0; i != ingest_size; ++i)
+        {
+            keys.push_back(dis(gen));
+        }
+
+        BENCHMARK("add one at a time, 1M unsorted keys")
+        {
+            red_black_tree<int> rb;
+            for (auto k : keys)
+            {
+                rb.add(k);
+            }
+            return rb.size();
+        };
+
+        BENCHMARK("container constructor, 1M unsorted keys")
+        {
+            return red_black_tree<int>(std::vector<int>(keys)).size();
+        };
+
+        BENCHMARK("from_unsorted, 1M unsorted keys")
+        {
+            return red_black_tree<int>::from_unsorted(keys).size();
+        };
+    }
+
+    TEST_CASE("copying vs snapshotting for readers", "[benchmark]")
+    {
+        auto const rb = random_set(large_set_size, 8);
+        persistent_red_black_tree<int> persistent;
+        for (auto i : rb)
+        {
+            persistent.add(i);
+        }
+
+        BENCHMARK("red_black_tree add, 200K elements")
+        {
+            return random_set(large_set_size, 8).size();
+        };
+
+        BENCHMARK("persistent_red_black_tree add, 200K elements")
+        {
+            persistent_red_black_tree<int> p;
+            for (auto i : rb)
+            {
+                p.add(i);
+            }
+            return p.size();
+        };
+
+        BENCHMARK("red_black_tree copy, 200K elements")
+        {
+            return red_black_tree<int>(rb).size();
+        };
+
+        BENCHMARK("persistent_red_black_tree snapshot, 200K elements")
+        {
+            return persistent.snapshot().size();
+        };
+    }
+
+    TEST_CASE("plain vs compact red black nodes", "[benchmark]")
+    {
+        std::mt19937 gen(12);
+        std::uniform_int_distribution<long> dis(0, 10L * ingest_size);
+        std::vector<long> keys;
+        for (int i = 0; i != ingest_size; ++i)
+        {
+            keys.push_back(dis(gen));
+        }
+
+        std::cout << "red_black_tree<long> node "
+                  << sizeof(red_black_tree<long>::node_type)
+                  << " bytes, compact_red_black_tree<long> node "
+                  << sizeof(compact_red_black_tree<long>::node_type)
+                  << " bytes\n";
+
+        auto const fill = [&keys](auto &&rb) {
+            for (auto k : keys)
+            {
+                rb.add(k);
+            }
+            return rb;
+        };
+
+        BENCHMARK("red_black_tree add, 1M random longs")
+        {
+            return fill(red_black_tree<long>()).size();
+        };
+
+        BENCHMARK("compact_red_black_tree add, 1M random longs")
+        {
+            return fill(compact_red_black_tree<long>()).size();
+        };
+
+        auto const plain = fill(red_black_tree<long>());
+        auto const compact = fill(compact_red_black_tree<long>());
+
+        BENCHMARK("red_black_tree contains, 1M random longs")
+        {
+            std::size_t found = 0;
+            for (auto k : keys)
+            {
+                found += plain.contains(k);
+            }
+            return found;
+        };
+
+        BENCHMARK("compact_red_black_tree contains, 1M random longs")
+        {
+            std::size_t found = 0;
+            for (auto k : keys)
+            {
+                found += compact.contains(k);
+            }
+            return found;
+        };
+    }
+
+    TEST_CASE("pointer vs index linked red black nodes", "[benchmark]")
+    {
+        std::mt19937 gen(12);
+        std::uniform_int_distribution<int> dis(0, 10 * ingest_size);
+        std::vector<int> keys;
+        for (int i = 0; i != ingest_size; ++i)
+        {
+            keys.push_back(dis(gen));
+        }
+
+        std::cout << "pooled_red_black_tree<int> node "
+                  << sizeof(pooled_red_black_tree<int>::node_type)
+                  << " bytes, indexed_red_black_tree<int> node "
+                  << sizeof(indexed_red_black_tree<int>::node_type)
+                  << " bytes\n";
+
+        auto const fill = [&keys](auto &&rb) {
+            for (auto k : keys)
+            {
+                rb.add(k);
+            }
+            return rb;
+        };
+
+        BENCHMARK("pooled_red_black_tree add, 1M random ints")
+        {
+            return fill(pooled_red_black_tree<int>()).size();
+        };
+
+        BENCHMARK("indexed_red_black_tree add, 1M random ints")
+        {
+            return fill(indexed_red_black_tree<int>()).size();
+        };
+
+        auto const pooled = fill(pooled_red_black_tree<int>());
+        auto const indexed = fill(indexed_red_black_tree<int>());
+
+        BENCHMARK("pooled_red_black_tree contains, 1M random ints")
+        {
+            std::size_t found = 0;
+            for (auto k : keys)
+            {
+                found += pooled.contains(k);
+            }
+            return found;
+        };
+
+        BENCHMARK("indexed_red_black_tree contains, 1M random ints")
+        {
+            std::size_t found = 0;
+            for (auto k : keys)
+            {
+                found += indexed.contains(k);
+            }
+            return found;
+        };
+    }
+} // namespace csb::bench
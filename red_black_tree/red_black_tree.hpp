@@ -4,7 +4,10 @@
 #include <binary_tree/binary_tree.hpp>
 #include <binary_tree/tree_utils.hpp>
 
+#include <cstddef>
+#include <functional>
 #include <memory>
+#include <ostream>
 
 namespace csb
 {
@@ -16,7 +19,7 @@ namespace csb
             Black
         };
 
-        std::ostream &operator<<(std::ostream &os, Colour const &c)
+        inline std::ostream &operator<<(std::ostream &os, Colour const &c)
         {
 
             switch (c)
@@ -36,8 +39,58 @@ namespace csb
             Colour colour = Colour::Red;
         };
 
-        template <typename T, typename M>
-        binary_tree_node<T, M> *find_aunt(binary_tree_node<T, M> *n)
+        /*
+         * keeps the colour in the lowest bit of the node's parent pointer
+         * instead, set for black. A byte of colour next to the element
+         * usually costs a whole word once the node is padded, so this makes
+         * e.g. a red_black_tree<long> node 32 bytes rather than 40
+         */
+        struct compact_red_black_node_meta_data
+        {
+            template <typename Node>
+            using parent_pointer = tagged_pointer<Node>;
+        };
+
+        // everything gets at the colour through these, so that it works
+        // whichever of the two metadata a node has
+
+        template <typename T, typename M, typename A>
+        Colour colour_of(binary_tree_node<T, M, A> const &node)
+        {
+            if constexpr (binary_tree_node<T, M, A>::has_tagged_parent)
+            {
+                return node.parent.tag() ? Colour::Black : Colour::Red;
+            }
+            else
+            {
+                return node.metadata().colour;
+            }
+        }
+
+        template <typename T, typename M, typename A>
+        void set_colour(binary_tree_node<T, M, A> &node, Colour colour)
+        {
+            if constexpr (binary_tree_node<T, M, A>::has_tagged_parent)
+            {
+                node.parent.set_tag(colour == Colour::Black);
+            }
+            else
+            {
+                node.metadata().colour = colour;
+            }
+        }
+
+        template <typename T, typename M, typename A>
+        void swap_colours(binary_tree_node<T, M, A> &l,
+                          binary_tree_node<T, M, A> &r)
+        {
+            auto const colour = colour_of(l);
+            set_colour(l, colour_of(r));
+            set_colour(r, colour);
+        }
+
+        template <typename T, typename M, typename A>
+        binary_tree_node<T, M, A> *find_aunt(binary_tree_node<T, M, A> *n)
         {
             if (n == nullptr || n->parent == nullptr ||
                 n->parent->parent == nullptr)
@@ -58,9 +111,11 @@ namespace csb
             }
         }
 
-        template <typename T>
-        bool
-        is_left_left(binary_tree_node<T, red_black_node_meta_data> const &node)
+        // the helpers below work on any metadata deriving from either of
+        // the red black metadata, so augmented red black trees can use them
+
+        template <typename T, typename M, typename A>
+        bool is_left_left(binary_tree_node<T, M, A> const &node)
         {
             // if node is in its parents left subtree which is in turn in its
             // parents left subtree
@@ -68,9 +123,8 @@ namespace csb
                    node.parent->parent->left.get() == node.parent;
         }
 
-        template <typename T>
-        bool
-        is_left_right(binary_tree_node<T, red_black_node_meta_data> const &node)
+        template <typename T, typename M, typename A>
+        bool is_left_right(binary_tree_node<T, M, A> const &node)
         {
             // if node is in its parents right subtree which is in turn in its
             // parents left subtree
@@ -78,9 +132,8 @@ namespace csb
                    node.parent->parent->left.get() == node.parent;
         }
 
-        template <typename T>
-        bool is_right_right(
-            binary_tree_node<T, red_black_node_meta_data> const &node)
+        template <typename T, typename M, typename A>
+        bool is_right_right(binary_tree_node<T, M, A> const &node)
         {
             // if node is in its parents right subtree which is in turn in its
             // parents right subtree
@@ -88,9 +141,8 @@ namespace csb
                    node.parent->parent->right.get() == node.parent;
         }
 
-        template <typename T>
-        bool
-        is_right_left(binary_tree_node<T, red_black_node_meta_data> const &node)
+        template <typename T, typename M, typename A>
+        bool is_right_left(binary_tree_node<T, M, A> const &node)
         {
             // if node is in its parents left subtree which is in turn in its
             // parents right subtree
@@ -98,26 +150,37 @@ namespace csb
                    node.parent->parent->right.get() == node.parent;
         }
 
-        template <typename T>
-        bool is_red(binary_tree_node<T, red_black_node_meta_data> const *node)
+        template <typename T, typename M, typename A>
+        bool is_red(binary_tree_node<T, M, A> const *node)
         {
-            return node != nullptr &&
-                   node->metadata().colour == impl::Colour::Red;
+            return node != nullptr && colour_of(*node) == impl::Colour::Red;
         }
 
-        template <typename T>
-        bool is_black(binary_tree_node<T, red_black_node_meta_data> const *node)
+        template <typename T, typename M, typename A>
+        bool is_black(binary_tree_node<T, M, A> const *node)
         {
             return !is_red(node);
         }
 
-        template <typename T>
-        bool is_root(binary_tree_node<T, red_black_node_meta_data> const *node)
+        template <typename T, typename M, typename A>
+        bool is_root(binary_tree_node<T, M, A> const *node)
         {
             return node != nullptr && node->parent == nullptr;
         }
 
-        impl::Colour flipped(impl::Colour colour)
+        /** black nodes on each path from n down to a leaf, counting n */
+        template <typename T, typename M, typename A>
+        std::size_t black_height(binary_tree_node<T, M, A> const *n)
+        {
+            std::size_t height = 0;
+            for (; n != nullptr; n = n->left.get())
+            {
+                height += is_black(n) ? 1 : 0;
+            }
+            return height;
+        }
+
+        inline impl::Colour flipped(impl::Colour colour)
         {
             return colour == impl::Colour::Red ? impl::Colour::Black
                                                : impl::Colour::Red;
@@ -127,58 +190,192 @@ namespace csb
         {
             using node_metadata_type = red_black_node_meta_data;
 
-            template <typename T>
-            using node_type = binary_tree_node<T, red_black_node_meta_data>;
+            template <typename T,
+                      typename AllocationPolicy = heap_allocation_policy>
+            using node_type =
+                binary_tree_node<T, node_metadata_type, AllocationPolicy>;
 
-            template <typename T>
-            static std::unique_ptr<node_type<T>>
-            balance(std::unique_ptr<node_type<T>> root, node_type<T> *node)
+            template <typename Node>
+            static typename Node::pointer
+            balance(typename Node::pointer root, Node *node)
             {
                 auto newRoot = balance_impl(std::move(root), node);
-                newRoot->metadata().colour = Colour::Black;
-                return std::move(newRoot);
+                set_colour(*newRoot, Colour::Black);
+                return newRoot;
             }
 
-            template <typename T>
-            static std::unique_ptr<node_type<T>>
-            erase_node(std::unique_ptr<node_type<T>> root, node_type<T> &target)
+            template <typename Node>
+            static typename Node::pointer
+            erase_node(typename Node::pointer root, Node &target,
+                       typename Node::pointer &removed)
             {
                 // basically we ensure that the node to be deleted has at most
-                // one child
+                // one child. Swapping rather than copying the element means
+                // the node removed holds the element being erased
                 if (target.left != nullptr && target.right != nullptr)
                 {
                     auto newTarget = leftmost(target.right.get());
-                    target.t = newTarget->t;
-                    return erase_node_impl(std::move(root), *newTarget);
+                    std::swap(target.t, newTarget->t);
+                    return erase_node_impl(std::move(root), *newTarget,
+                                           removed);
+                }
+                else
+                {
+                    return erase_node_impl(std::move(root), target, removed);
+                }
+            }
+
+            /** joins balance by black height, O(log n) to measure */
+            template <typename Node> static std::size_t rank(Node const *root)
+            {
+                return black_height(root);
+            }
+
+            /** a node's children have its black height, less it if black */
+            template <typename Node>
+            static std::size_t child_rank(Node const &node, std::size_t rank,
+                                          Node const *child)
+            {
+                (void)child;
+                return rank - (is_black(&node) ? 1 : 0);
+            }
+
+            /*
+             * joins left and right under mid, where everything in left is
+             * less than mid and everything in right is greater. If the two
+             * trees have the same black height mid goes on top. Otherwise mid
+             * is spliced, red, into the facing spine of the taller tree at
+             * the first black node with the shorter tree's black height and
+             * then fixed up like a fresh insertion. Both steps are bounded by
+             * the difference in the black heights, O(|h1 - h2| + 1)
+             */
+            template <typename Node>
+            static ranked_tree<typename Node::pointer>
+            join(ranked_tree<typename Node::pointer> left,
+                 typename Node::pointer mid,
+                 ranked_tree<typename Node::pointer> right)
+            {
+                // a red root can always be made black, which adds one to
+                // its black height
+                for (auto tree : {&left, &right})
+                {
+                    if (is_red(tree->root.get()))
+                    {
+                        set_colour(*tree->root, Colour::Black);
+                        ++tree->rank;
+                    }
+                }
+
+                auto const m = mid.get();
+                if (left.rank == right.rank)
+                {
+                    set_colour(*m, Colour::Black);
+                    adopt(*m, std::move(left.root), std::move(right.root));
+                    return {std::move(mid), left.rank + 1};
+                }
+
+                auto const into_left = left.rank > right.rank;
+                auto &taller = into_left ? left : right;
+                auto &shorter = into_left ? right : left;
+
+                // walk down the spine, height is the black height of *link
+                auto height = taller.rank;
+                Node *parent = nullptr;
+                auto link = &taller.root;
+                while (!is_black(link->get()) || height != shorter.rank)
+                {
+                    parent = link->get();
+                    height -= is_black(parent) ? 1 : 0;
+                    link = into_left ? &parent->right : &parent->left;
+                }
+
+                set_colour(*m, Colour::Red);
+                if (into_left)
+                {
+                    adopt(*m, std::move(*link), std::move(shorter.root));
                 }
                 else
                 {
-                    return erase_node_impl(std::move(root), target);
+                    adopt(*m, std::move(shorter.root), std::move(*link));
                 }
+                m->parent = parent;
+                *link = std::move(mid);
+                m->refresh_path();
+
+                taller.root = fix_up(std::move(taller.root), m, taller.rank);
+                return std::move(taller);
+            }
+
+            template <typename Node>
+            static void bulk_load_node(Node &node, std::size_t depth,
+                                       std::size_t height)
+            {
+                // a bulk loaded tree has every level full apart from maybe
+                // the last one. Colouring just the deepest level red keeps
+                // the black height the same along every path
+                set_colour(node, depth != 0 && depth + 1 == height
+                                     ? Colour::Red
+                                     : Colour::Black);
             }
 
           private:
-            template <typename T>
-            static std::unique_ptr<node_type<T>>
-            recolour(std::unique_ptr<node_type<T>> root, node_type<T> *node)
+            /*
+             * balance without the recursion, for a join. Recolouring and
+             * rotating keep every black height below the root, so the
+             * tree's only grows if recolouring reaches the root and it has
+             * to be made black again, which adds one to rank
+             */
+            template <typename Node>
+            static typename Node::pointer
+            fix_up(typename Node::pointer root, Node *node, std::size_t &rank)
             {
-                auto grandparent = node->parent->parent;
-                grandparent->metadata().colour = Colour::Red;
+                // the root is black, so a red parent always has a parent
+                Node *parent = node->parent;
+                while (node != root.get() && is_red(parent))
+                {
+                    auto aunt = find_aunt(node);
+                    if (is_black(aunt))
+                    {
+                        return rotate(std::move(root), node);
+                    }
+
+                    Node *const grandparent = parent->parent;
+                    set_colour(*grandparent, Colour::Red);
+                    set_colour(*aunt, Colour::Black);
+                    set_colour(*parent, Colour::Black);
+                    node = grandparent;
+                    parent = node->parent;
+                }
+
+                if (is_red(root.get()))
+                {
+                    set_colour(*root, Colour::Black);
+                    ++rank;
+                }
+                return root;
+            }
+
+            template <typename Node>
+            static typename Node::pointer
+            recolour(typename Node::pointer root, Node *node)
+            {
+                Node *const grandparent = node->parent->parent;
+                set_colour(*grandparent, Colour::Red);
 
                 auto aunt = find_aunt(node);
-                aunt->metadata().colour = Colour::Black;
-                node->parent->metadata().colour = Colour::Black;
+                set_colour(*aunt, Colour::Black);
+                set_colour(*node->parent, Colour::Black);
 
                 return balance(std::move(root), grandparent);
             }
 
-            template <typename T>
-            static std::unique_ptr<node_type<T>>
-            rotate(std::unique_ptr<node_type<T>> root, node_type<T> *node)
+            template <typename Node>
+            static typename Node::pointer
+            rotate(typename Node::pointer root, Node *node)
             {
                 (void)node;
-                auto grandparent = node->parent->parent;
-                auto great_grandparent = grandparent->parent;
+                Node *const grandparent = node->parent->parent;
+                Node *const great_grandparent = grandparent->parent;
                 decltype(root) *link = nullptr;
                 if (great_grandparent == nullptr)
                 {
@@ -193,46 +390,43 @@ namespace csb
                 if (is_left_left(*node))
                 {
                     *link = right_rotate(std::move(*link));
-                    std::swap(link->get()->metadata().colour,
-                              link->get()->right->metadata().colour);
+                    swap_colours(*link->get(), *link->get()->right);
                 }
                 else if (is_left_right(*node))
                 {
                     *link = left_right_rotate(std::move(*link));
-                    std::swap(link->get()->metadata().colour,
-                              link->get()->right->metadata().colour);
+                    swap_colours(*link->get(), *link->get()->right);
                 }
                 else if (is_right_right(*node))
                 {
                     *link = left_rotate(std::move(*link));
-                    std::swap(link->get()->metadata().colour,
-                              link->get()->left->metadata().colour);
+                    swap_colours(*link->get(), *link->get()->left);
                 }
                 else
                 { // must be right left
                     *link = right_left_rotate(std::move(*link));
-                    std::swap(link->get()->metadata().colour,
-                              link->get()->left->metadata().colour);
+                    swap_colours(*link->get(), *link->get()->left);
                 }
 
-                return std::move(root);
+                return root;
             }
 
-            template <typename T>
-            static std::unique_ptr<node_type<T>>
-            balance_impl(std::unique_ptr<node_type<T>> root, node_type<T> *node)
+            template <typename Node>
+            static typename Node::pointer
+            balance_impl(typename Node::pointer root, Node *node)
             {
                 // 1st node so just make sure root is black
                 if (root.get() == node)
                 {
-                    root->metadata().colour = Colour::Black;
-                    return std::move(root);
+                    set_colour(*root, Colour::Black);
+                    return root;
                 }
 
                 // iF parent is black then all criteria will be met
-                if (is_black(node->parent))
+                Node const *const parent = node->parent;
+                if (is_black(parent))
                 {
-                    return std::move(root);
+                    return root;
                 }
 
                 auto aunt = find_aunt(node);
@@ -246,19 +440,19 @@ namespace csb
                     root = recolour(std::move(root), node);
                 }
 
-                return std::move(root);
+                return root;
             }
 
             /*
              * s is black an has at least 1 red child, r
              * rotate based on the position of s and r
              */
-            template <typename T>
-            static std::unique_ptr<node_type<T>>
-            case_1(std::unique_ptr<node_type<T>> root, node_type<T> *,
-                   node_type<T> *parent, node_type<T> *sibling)
+            template <typename Node>
+            static typename Node::pointer
+            case_1(typename Node::pointer root, Node *, Node *parent,
+                   Node *sibling)
             {
-                auto &strong_parent = [&]() -> std::unique_ptr<node_type<T>> & {
+                auto &strong_parent = [&]() -> typename Node::pointer & {
                     if (parent->parent == nullptr)
                     {
                         return root;
@@ -279,19 +473,17 @@ namespace csb
                     if (is_red(sibling->left.get()))
                     {
                         // left left case
-                        sibling->left->metadata().colour =
-                            sibling->metadata().colour;
-                        sibling->metadata().colour = parent->metadata().colour;
-                        parent->metadata().colour = impl::Colour::Black;
+                        set_colour(*sibling->left, colour_of(*sibling));
+                        set_colour(*sibling, colour_of(*parent));
+                        set_colour(*parent, impl::Colour::Black);
                         strong_parent = right_rotate(std::move(strong_parent));
                     }
                     else
                     {
                         // left right case
-                        sibling->right->metadata().colour =
-                            parent->metadata().colour;
+                        set_colour(*sibling->right, colour_of(*parent));
                         parent->left = left_rotate(std::move(parent->left));
-                        parent->metadata().colour = impl::Colour::Black;
+                        set_colour(*parent, impl::Colour::Black);
                         strong_parent = right_rotate(std::move(strong_parent));
                     }
                 }
@@ -300,23 +492,21 @@ namespace csb
                     if (is_red(sibling->left.get()))
                     {
                         // right left case
-                        sibling->left->metadata().colour =
-                            parent->metadata().colour;
+                        set_colour(*sibling->left, colour_of(*parent));
                         parent->right = right_rotate(std::move(parent->right));
-                        parent->metadata().colour = impl::Colour::Black;
+                        set_colour(*parent, impl::Colour::Black);
                         strong_parent = left_rotate(std::move(strong_parent));
                     }
                     else
                     {
                         // right right case
-                        sibling->right->metadata().colour =
-                            sibling->metadata().colour;
-                        sibling->metadata().colour = parent->metadata().colour;
-                        parent->metadata().colour = impl::Colour::Black;
+                        set_colour(*sibling->right, colour_of(*sibling));
+                        set_colour(*sibling, colour_of(*parent));
+                        set_colour(*parent, impl::Colour::Black);
                         strong_parent = left_rotate(std::move(strong_parent));
                     }
                 }
-                return std::move(root);
+                return root;
             }
 
             /*
@@ -325,21 +515,20 @@ namespace csb
              * if parent is red, colour it black and your done
              * else recur on p
              */
-            template <typename T>
-            static std::unique_ptr<node_type<T>>
-            case_2(std::unique_ptr<node_type<T>> root, node_type<T> &parent,
-                   node_type<T> *sibling)
+            template <typename Node>
+            static typename Node::pointer
+            case_2(typename Node::pointer root, Node &parent, Node *sibling)
             {
 
                 if (sibling != nullptr)
                 {
-                    sibling->metadata().colour = impl::Colour::Red;
+                    set_colour(*sibling, impl::Colour::Red);
                 }
 
-                if (parent.metadata().colour == impl::Colour::Red)
+                if (colour_of(parent) == impl::Colour::Red)
                 {
-                    parent.metadata().colour = impl::Colour::Black;
-                    return std::move(root);
+                    set_colour(parent, impl::Colour::Black);
+                    return root;
                 }
                 else
                 {
@@ -348,12 +537,13 @@ namespace csb
                         return case_4(std::move(root));
                     }
                     // recur
+                    Node *const grandparent = parent.parent;
                     auto &newSibling = (is_left_child(parent))
-                                           ? parent.parent->right
-                                           : parent.parent->left;
+                                           ? grandparent->right
+                                           : grandparent->left;
                     return fix_double_black_impl(std::move(root),
                                                  &parent,
-                                                 parent.parent,
+                                                 grandparent,
                                                  newSibling.get());
                 }
             }
@@ -364,16 +554,15 @@ namespace csb
              * rotate around s
              * then recur
              */
-            template <typename T>
-            static std::unique_ptr<node_type<T>>
-            case_3(std::unique_ptr<node_type<T>> root, node_type<T> *,
-                   node_type<T> *parent, node_type<T> *sibling)
+            template <typename Node>
+            static typename Node::pointer
+            case_3(typename Node::pointer root, Node *, Node *parent,
+                   Node *sibling)
             {
 
-                std::swap(sibling->metadata().colour,
-                          parent->metadata().colour);
+                swap_colours(*sibling, *parent);
 
-                auto &strong_parent = [&]() -> std::unique_ptr<node_type<T>> & {
+                auto &strong_parent = [&]() -> typename Node::pointer & {
                     if (parent->parent == nullptr)
                     {
                         return root;
@@ -411,24 +600,20 @@ namespace csb
             /*
              * v is root, set black and return it
              */
-            template <typename T>
-            static std::unique_ptr<node_type<T>>
-            case_4(std::unique_ptr<node_type<T>> root)
+            template <typename Pointer> static Pointer case_4(Pointer root)
             {
                 if (root != nullptr)
                 {
-                    root->metadata().colour = impl::Colour::Black;
+                    set_colour(*root, impl::Colour::Black);
                 }
-                return std::move(root);
+                return root;
             }
 
-            template <typename T, typename Metadata>
-            static std::unique_ptr<binary_tree_node<T, Metadata>>
-            fix_double_black_impl(
-                std::unique_ptr<binary_tree_node<T, Metadata>> root,
-                binary_tree_node<T, Metadata> *doubleBlack,
-                binary_tree_node<T, Metadata> *parent,
-                binary_tree_node<T, Metadata> *sibling)
+            template <typename Node>
+            static typename Node::pointer
+            fix_double_black_impl(typename Node::pointer root,
+                                  Node *doubleBlack, Node *parent,
+                                  Node *sibling)
             {
 
                 if (parent == nullptr)
@@ -451,17 +636,16 @@ namespace csb
                 return case_1(std::move(root), doubleBlack, parent, sibling);
             }
 
-            template <typename T, typename Metadata>
-            static std::unique_ptr<binary_tree_node<T, Metadata>>
-            fix_double_black(
-                std::unique_ptr<binary_tree_node<T, Metadata>> root,
-                binary_tree_node<T, Metadata> &target,
-                std::unique_ptr<binary_tree_node<T, Metadata>> child = nullptr)
+            template <typename Node>
+            static typename Node::pointer
+            fix_double_black(typename Node::pointer root, Node &target,
+                             typename Node::pointer &removed,
+                             typename Node::pointer child = nullptr)
             {
-                auto parent = target.parent;
+                Node *const parent = target.parent;
                 auto doubleBlack = child.get();
 
-                binary_tree_node<T, Metadata> *sibling = nullptr;
+                Node *sibling = nullptr;
                 if (parent == nullptr)
                 {
                     sibling = nullptr;
@@ -475,7 +659,8 @@ namespace csb
                     sibling = target.parent->left.get();
                 }
 
-                root = detach(std::move(root), target, std::move(child));
+                root = detach(std::move(root), target, removed,
+                              std::move(child));
 
                 if (root == nullptr)
                 {
@@ -488,10 +673,10 @@ namespace csb
                 }
             }
 
-            template <typename T>
-            static std::unique_ptr<node_type<T>>
-            erase_node_impl(std::unique_ptr<node_type<T>> root,
-                            node_type<T> &target)
+            template <typename Node>
+            static typename Node::pointer
+            erase_node_impl(typename Node::pointer root, Node &target,
+                            typename Node::pointer &removed)
             {
                 auto &child =
                     target.left != nullptr ? target.left : target.right;
@@ -499,24 +684,80 @@ namespace csb
                 // if red then just delete
                 if (is_red(&target))
                 {
-                    return detach(std::move(root), target, std::move(child));
+                    return detach(std::move(root), target, removed,
+                                  std::move(child));
                 }
 
                 // child is red, colour black and replace target with it
                 if (is_red(child.get()))
                 {
-                    child->metadata().colour = Colour::Black;
-                    return detach(std::move(root), target, std::move(child));
+                    set_colour(*child, Colour::Black);
+                    return detach(std::move(root), target, removed,
+                                  std::move(child));
                 }
 
                 return fix_double_black(
-                    std::move(root), target, std::move(child));
+                    std::move(root), target, removed, std::move(child));
             }
         };
+
+        /** the same balancing with the colour packed into the parent */
+        struct compact_red_black_tree_balancing : red_black_tree_balancing
+        {
+            using node_metadata_type = compact_red_black_node_meta_data;
+
+            template <typename T,
+                      typename AllocationPolicy = heap_allocation_policy>
+            using node_type =
+                binary_tree_node<T, node_metadata_type, AllocationPolicy>;
+        };
     } // namespace impl
 
-    template <typename T>
-    using red_black_tree = binary_tree<T, impl::red_black_tree_balancing>;
+    template <typename T, typename Compare = std::less<T>>
+    using red_black_tree =
+        binary_tree<T, impl::red_black_tree_balancing,
+                    impl::heap_allocation_policy, Compare>;
+
+    /** red_black_tree with O(log n) nth and rank */
+    template <typename T, typename Compare = std::less<T>>
+    using order_statistic_tree = binary_tree<
+        T, impl::order_statistic_policy<impl::red_black_tree_balancing>,
+        impl::heap_allocation_policy, Compare>;
+
+    /** red_black_tree whose iterators step in O(1) by following threads */
+    template <typename T, typename Compare = std::less<T>>
+    using threaded_red_black_tree =
+        binary_tree<T, impl::threaded_policy<impl::red_black_tree_balancing>,
+                    impl::heap_allocation_policy, Compare>;
+
+    /** red_black_tree with a node a word smaller for most T */
+    template <typename T, typename Compare = std::less<T>>
+    using compact_red_black_tree =
+        binary_tree<T, impl::compact_red_black_tree_balancing,
+                    impl::heap_allocation_policy, Compare>;
+
+    template <typename T, typename Compare = std::less<T>>
+    using pooled_red_black_tree =
+        binary_tree<T, impl::red_black_tree_balancing,
+                    impl::pool_allocation_policy, Compare>;
+
+    /*
+     * the pool hands out slots of exactly the node's size, where malloc
+     * would round a 32 and a 40 byte node up to the same chunk
+     */
+    template <typename T, typename Compare = std::less<T>>
+    using pooled_compact_red_black_tree =
+        binary_tree<T, impl::compact_red_black_tree_balancing,
+                    impl::pool_allocation_policy, Compare>;
+
+    /**
+     * red_black_tree with smaller nodes, linked by 32 bit index into the
+     * process wide node_arena for their size, see index_allocation_policy
+     */
+    template <typename T, typename Compare = std::less<T>>
+    using indexed_red_black_tree =
+        binary_tree<T, impl::red_black_tree_balancing,
+                    impl::index_allocation_policy, Compare>;
 
 } // namespace csb
 
@@ -3,6 +3,11 @@
 #include <algorithm>
 #include <catch2/catch.hpp>
 #include <iostream>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
 
 namespace csb
 {
@@ -60,8 +65,7 @@ namespace csb
             return node;
         }
 
-        auto compute_black_height(red_black_tree<int>::node_type const *n)
-            -> int
+        template <typename Node> int compute_black_height(Node const *n)
         {
             if (n == nullptr)
                 return 0;
@@ -81,8 +85,7 @@ namespace csb
             else
             {
                 // add to height if the colour of the node is black
-                return left_height +
-                       (n->metadata().colour == impl::Colour::Black ? 1 : 0);
+                return left_height + (impl::is_black(n) ? 1 : 0);
             }
         }
 
@@ -121,6 +124,35 @@ namespace csb
         {
             return tree_height(n, std::max);
         }
+
+        template <typename Tree> bool is_valid_red_black_tree(Tree const &rb)
+        {
+            if (rb.is_empty())
+            {
+                return true;
+            }
+
+            typename Tree::node_type const *root = &rb.begin().node();
+            while (root->parent != nullptr)
+            {
+                root = root->parent;
+            }
+            if (!impl::is_black(root) || compute_black_height(root) < 0)
+            {
+                return false;
+            }
+
+            for (auto it = rb.begin(); it != rb.end(); ++it)
+            {
+                if (impl::is_red(&it.node()) &&
+                    (impl::is_red(it.node().left.get()) ||
+                     impl::is_red(it.node().right.get())))
+                {
+                    return false;
+                }
+            }
+            return std::is_sorted(rb.begin(), rb.end());
+        }
     } // namespace
     SCENARIO("insert at root")
     {
@@ -867,6 +899,875 @@ namespace csb
         }
     }
 
+    SCENARIO("bulk loading a red black tree")
+    {
+        GIVEN("sorted ranges of every size up to 130")
+        {
+            // plain checks in the loop, sections inside it would only
+            // ever run for the first size
+            THEN("each is a valid red black tree and stays one after more "
+                 "insertions and deletions")
+            {
+                for (int n = 1; n <= 130; ++n)
+                {
+                    INFO("n = " << n);
+                    std::vector<int> sorted(n);
+                    std::iota(sorted.begin(), sorted.end(), 0);
+
+                    auto rb = red_black_tree<int>::from_sorted(sorted.begin(),
+                                                               sorted.end());
+                    auto root = level_order(rb).front();
+
+                    // the root is black and every route from root to leaf
+                    // has the same number of black nodes
+                    REQUIRE(root->metadata().colour == impl::Colour::Black);
+                    REQUIRE(compute_black_height(root) >= 0);
+
+                    // there are no adjacent red nodes
+                    for (auto it = rb.begin(); it != rb.end(); ++it)
+                    {
+                        if (it.node().metadata().colour == impl::Colour::Red)
+                        {
+                            REQUIRE(impl::is_black(it.node().left.get()));
+                            REQUIRE(impl::is_black(it.node().right.get()));
+                        }
+                    }
+
+                    rb.add(-1);
+                    rb.add(n);
+                    rb.erase(n / 2);
+
+                    auto const new_root = level_order(rb).front();
+                    REQUIRE(compute_black_height(new_root) >= 0);
+                    REQUIRE(rb.size() == static_cast<std::size_t>(n + 1));
+                }
+            }
+        }
+    }
+
+    SCENARIO("heterogeneous lookup")
+    {
+        GIVEN("a red black tree of strings with a transparent comparator")
+        {
+            red_black_tree<std::string, std::less<>> rb;
+            insert(rb, "apple", "banana", "cherry", "damson", "elderberry");
+
+            THEN("it can be searched with string_views")
+            {
+                using namespace std::string_view_literals;
+
+                REQUIRE(rb.contains("cherry"sv));
+                REQUIRE(*rb.find("damson"sv) == "damson");
+                REQUIRE(rb.find("fig"sv) == rb.end());
+            }
+
+            WHEN("erasing with a string_view")
+            {
+                rb.erase(std::string_view("banana"));
+
+                THEN("the element is removed")
+                {
+                    REQUIRE(rb.size() == 4);
+                    REQUIRE_FALSE(rb.contains(std::string_view("banana")));
+                    REQUIRE(*rb.begin() == "apple");
+                    REQUIRE(*++rb.begin() == "cherry");
+                }
+            }
+        }
+
+        GIVEN("a red black tree of strings using three_way_compare")
+        {
+            red_black_tree<std::string, three_way_compare> rb;
+            insert(rb, "damson", "apple", "elderberry", "cherry", "banana");
+
+            THEN("it is ordered and searchable like any other")
+            {
+                REQUIRE(*rb.begin() == "apple");
+                REQUIRE(*--rb.end() == "elderberry");
+                REQUIRE(rb.contains(std::string_view("cherry")));
+                REQUIRE_FALSE(rb.contains(std::string_view("fig")));
+            }
+        }
+    }
+
+    SCENARIO("pool allocated red black tree")
+    {
+        GIVEN("a pooled red black tree with a run of sorted insertions")
+        {
+            pooled_red_black_tree<int> rb;
+            for (int i = 0; i != 1000; ++i)
+            {
+                rb.add(i);
+            }
+
+            WHEN("erasing every other element")
+            {
+                for (int i = 0; i < 1000; i += 2)
+                {
+                    rb.erase(i);
+                }
+
+                THEN("only the odd elements remain, in order")
+                {
+                    REQUIRE(rb.size() == 500);
+
+                    auto expected = 1;
+                    for (auto i : rb)
+                    {
+                        REQUIRE(i == expected);
+                        expected += 2;
+                    }
+                }
+            }
+        }
+    }
+
+    SCENARIO("hinted insertion")
+    {
+        GIVEN("a red black tree fed increasing keys with an end() hint")
+        {
+            red_black_tree<int> rb;
+            for (int i = 0; i != 1000; ++i)
+            {
+                auto const it = rb.add(rb.end(), i);
+                REQUIRE(*it == i);
+            }
+
+            THEN("it is ordered and balanced")
+            {
+                REQUIRE(rb.size() == 1000);
+                REQUIRE(std::is_sorted(rb.begin(), rb.end()));
+                REQUIRE(compute_black_height(level_order(rb).front()) >= 0);
+            }
+        }
+
+        GIVEN("a red black tree with gaps between its keys")
+        {
+            red_black_tree<int> rb;
+            for (int i = 0; i != 100; i += 10)
+            {
+                rb.add(i);
+            }
+
+            WHEN("adding with a hint to the element after the key")
+            {
+                auto const it = rb.add(rb.find(50), 45);
+
+                THEN("the key is added in place")
+                {
+                    REQUIRE(*it == 45);
+                    REQUIRE(*++rb.find(40) == 45);
+                    REQUIRE(rb.size() == 11);
+                }
+            }
+
+            WHEN("adding with hints that are wrong")
+            {
+                auto const low = rb.add(rb.end(), -5);
+                auto const mid = rb.add(rb.begin(), 55);
+                auto const high = rb.add(rb.find(20), 95);
+
+                THEN("the keys still end up in the right place")
+                {
+                    REQUIRE(*low == -5);
+                    REQUIRE(*mid == 55);
+                    REQUIRE(*high == 95);
+                    REQUIRE(rb.size() == 13);
+                    REQUIRE(std::is_sorted(rb.begin(), rb.end()));
+                    REQUIRE(compute_black_height(level_order(rb).front()) >=
+                            0);
+                }
+            }
+
+            WHEN("adding a key that is already there")
+            {
+                auto const it = rb.add(rb.find(30), 30);
+
+                THEN("the existing element is returned")
+                {
+                    REQUIRE(it == rb.find(30));
+                    REQUIRE(rb.size() == 10);
+                }
+            }
+        }
+
+        GIVEN("an order statistic tree fed near sorted keys")
+        {
+            order_statistic_tree<int> rb;
+            auto hint = rb.end();
+            for (int i = 0; i != 500; ++i)
+            {
+                // every tenth key is out of order
+                hint = rb.add(hint, i % 10 == 9 ? i - 500 : i);
+                ++hint;
+            }
+
+            THEN("the subtree sizes are kept up to date")
+            {
+                REQUIRE(rb.size() == 500);
+                REQUIRE(std::is_sorted(rb.begin(), rb.end()));
+                for (std::size_t i = 0; i != rb.size(); ++i)
+                {
+                    REQUIRE(rb.rank(*rb.nth(i)) == i);
+                }
+            }
+        }
+    }
+
+    SCENARIO("moving nodes between trees")
+    {
+        GIVEN("two red black trees")
+        {
+            red_black_tree<int> from;
+            red_black_tree<int> to;
+            for (int i = 0; i != 100; ++i)
+            {
+                (i % 2 == 0 ? from : to).add(i);
+            }
+
+            WHEN("extracting an element")
+            {
+                auto handle = from.extract(40);
+
+                THEN("the handle owns it and the tree no longer has it")
+                {
+                    REQUIRE_FALSE(handle.is_empty());
+                    REQUIRE(handle.value() == 40);
+                    REQUIRE_FALSE(from.contains(40));
+                    REQUIRE(from.size() == 49);
+                    REQUIRE(compute_black_height(level_order(from).front()) >=
+                            0);
+                }
+
+                AND_WHEN("inserting it into the other tree")
+                {
+                    auto const node = &handle.value();
+                    auto const [it, inserted] = to.insert(std::move(handle));
+
+                    THEN("the same node is linked into the other tree")
+                    {
+                        REQUIRE(inserted);
+                        REQUIRE(&*it == node);
+                        REQUIRE(*it == 40);
+                        REQUIRE(to.size() == 51);
+                        REQUIRE(std::is_sorted(to.begin(), to.end()));
+                        REQUIRE(compute_black_height(
+                                    level_order(to).front()) >= 0);
+                    }
+                }
+            }
+
+            WHEN("extracting an element that is not there")
+            {
+                auto handle = from.extract(41);
+
+                THEN("the handle is empty")
+                {
+                    REQUIRE(handle.is_empty());
+                    REQUIRE(from.size() == 50);
+                    REQUIRE_FALSE(to.insert(std::move(handle)).second);
+                }
+            }
+
+            WHEN("inserting an element the tree already has")
+            {
+                to.add(40);
+                auto handle = from.extract(40);
+                auto const [it, inserted] = to.insert(std::move(handle));
+
+                THEN("the handle keeps the node")
+                {
+                    REQUIRE_FALSE(inserted);
+                    REQUIRE(it == to.find(40));
+                    REQUIRE_FALSE(handle.is_empty());
+                    REQUIRE(to.size() == 51);
+                }
+            }
+
+            WHEN("moving every element across in a random order")
+            {
+                std::vector<int> keys(100);
+                std::iota(keys.begin(), keys.end(), 0);
+                std::shuffle(keys.begin(), keys.end(), std::mt19937(3));
+
+                for (auto k : keys)
+                {
+                    if (auto handle = from.extract(k))
+                    {
+                        REQUIRE(to.insert(std::move(handle)).second);
+                    }
+                }
+
+                THEN("one tree has everything and both are still valid")
+                {
+                    REQUIRE(from.is_empty());
+                    REQUIRE(from.begin() == from.end());
+                    REQUIRE(to.size() == 100);
+                    REQUIRE(std::is_sorted(to.begin(), to.end()));
+                    REQUIRE(compute_black_height(level_order(to).front()) >=
+                            0);
+                }
+            }
+        }
+
+        GIVEN("two order statistic trees")
+        {
+            order_statistic_tree<int> from{1, 2, 3, 4, 5, 6, 7};
+            order_statistic_tree<int> to{10, 20, 30};
+
+            WHEN("moving an element with two children across")
+            {
+                to.insert(from.extract(4));
+
+                THEN("the subtree sizes in both trees are right")
+                {
+                    REQUIRE(from.rank(5) == 3);
+                    REQUIRE(*from.nth(3) == 5);
+                    REQUIRE(to.rank(10) == 1);
+                    REQUIRE(*to.nth(0) == 4);
+                    REQUIRE(*to.nth(3) == 30);
+                }
+            }
+        }
+    }
+
+    SCENARIO("splitting and joining red black trees")
+    {
+        GIVEN("a red black tree of 1000 elements added in a random order")
+        {
+            std::vector<int> keys(1000);
+            std::iota(keys.begin(), keys.end(), 0);
+            std::shuffle(keys.begin(), keys.end(), std::mt19937(11));
+
+            red_black_tree<int> rb;
+            for (auto k : keys)
+            {
+                rb.add(k);
+            }
+
+            WHEN("splitting it at every tenth key")
+            {
+                THEN("both halves are valid, hold the right keys and join "
+                     "back into the original tree")
+                {
+                    for (int k = -5; k <= 1005; k += 10)
+                    {
+                        auto lower = rb;
+                        auto upper = lower.split(k);
+                        auto const cut = std::clamp(k, 0, 1000);
+
+                        REQUIRE(is_valid_red_black_tree(lower));
+                        REQUIRE(is_valid_red_black_tree(upper));
+                        REQUIRE(lower.size() == std::size_t(cut));
+                        REQUIRE(upper.size() == std::size_t(1000 - cut));
+                        if (!lower.is_empty())
+                        {
+                            REQUIRE(*--lower.end() == cut - 1);
+                        }
+                        if (!upper.is_empty())
+                        {
+                            REQUIRE(*upper.begin() == cut);
+                        }
+
+                        auto const joined = red_black_tree<int>::join(
+                            std::move(lower), std::move(upper));
+
+                        REQUIRE(is_valid_red_black_tree(joined));
+                        REQUIRE(joined == rb);
+                    }
+                }
+            }
+
+            WHEN("splitting the halves again and changing them")
+            {
+                auto upper = rb.split(600);
+                auto middle = rb.split(300);
+                upper.add(2000);
+                middle.erase(400);
+                rb.add(-1);
+
+                THEN("every piece still knows its exact size")
+                {
+                    for (auto const *t : {&rb, &middle, &upper})
+                    {
+                        REQUIRE(t->size() ==
+                                std::size_t(std::distance(t->begin(),
+                                                          t->end())));
+                    }
+                    REQUIRE(rb.size() == 301);
+                    REQUIRE(middle.size() == 299);
+                    REQUIRE(upper.size() == 401);
+                }
+            }
+
+            WHEN("joining it with a much smaller tree on either side")
+            {
+                red_black_tree<int> low{-3, -2, -1};
+                red_black_tree<int> high{1000, 1001};
+
+                auto joined = red_black_tree<int>::join(std::move(low),
+                                                        std::move(rb));
+                joined = red_black_tree<int>::join(std::move(joined),
+                                                   std::move(high));
+
+                THEN("the result holds every element and is still valid")
+                {
+                    REQUIRE(is_valid_red_black_tree(joined));
+                    REQUIRE(joined.size() == 1005);
+                    REQUIRE(*joined.begin() == -3);
+                    REQUIRE(*--joined.end() == 1001);
+                }
+            }
+        }
+
+        GIVEN("trees grown by joining single nodes onto their ends")
+        {
+            using ranked = ranked_tree<node_type::pointer>;
+            auto const join = [](ranked l, node_type::pointer m, ranked r) {
+                return impl::red_black_tree_balancing::join<node_type>(
+                    std::move(l), std::move(m), std::move(r));
+            };
+
+            THEN("every join reports the black height of the tree it makes")
+            {
+                ranked lower;
+                ranked upper;
+                for (int i = 0; i != 500; ++i)
+                {
+                    lower = join(std::move(lower), make_node(i, red()),
+                                 ranked());
+                    upper = join(ranked(), make_node(1999 - i, red()),
+                                 std::move(upper));
+                    REQUIRE(compute_black_height(lower.root.get()) ==
+                            static_cast<int>(lower.rank));
+                    REQUIRE(compute_black_height(upper.root.get()) ==
+                            static_cast<int>(upper.rank));
+                }
+
+                auto const joined = join(std::move(lower),
+                                         make_node(1000, red()),
+                                         std::move(upper));
+                REQUIRE(compute_black_height(joined.root.get()) ==
+                        static_cast<int>(joined.rank));
+                REQUIRE(impl::is_black(joined.root.get()));
+            }
+        }
+
+        GIVEN("an order statistic tree")
+        {
+            std::vector<int> sorted(100);
+            std::iota(sorted.begin(), sorted.end(), 0);
+            std::shuffle(sorted.begin(), sorted.end(), std::mt19937(5));
+
+            order_statistic_tree<int> rb;
+            for (auto i : sorted)
+            {
+                rb.add(i);
+            }
+
+            WHEN("splitting it")
+            {
+                auto upper = rb.split(37);
+
+                THEN("the subtree sizes of both halves are right")
+                {
+                    REQUIRE(rb.size() == 37);
+                    REQUIRE(upper.size() == 63);
+                    REQUIRE(*rb.nth(36) == 36);
+                    REQUIRE(*upper.nth(0) == 37);
+                    REQUIRE(upper.rank(50) == 13);
+                }
+            }
+        }
+    }
+
+    SCENARIO("set operations on red black trees")
+    {
+        GIVEN("two red black trees of random keys")
+        {
+            std::mt19937 gen(13);
+            std::uniform_int_distribution<> dis(0, 2000);
+
+            auto const random_keys = [&](int n) {
+                std::vector<int> keys;
+                for (int i = 0; i != n; ++i)
+                {
+                    keys.push_back(dis(gen));
+                }
+                std::sort(keys.begin(), keys.end());
+                keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+                std::shuffle(keys.begin(), keys.end(), gen);
+                return keys;
+            };
+
+            auto const a_keys = random_keys(1000);
+            auto const b_keys = random_keys(150);
+
+            red_black_tree<int> a;
+            red_black_tree<int> b;
+            for (auto k : a_keys)
+            {
+                a.add(k);
+            }
+            for (auto k : b_keys)
+            {
+                b.add(k);
+            }
+
+            std::vector<int const *> nodes;
+            for (auto const &k : a)
+            {
+                nodes.push_back(&k);
+            }
+            for (auto const &k : b)
+            {
+                nodes.push_back(&k);
+            }
+            std::sort(nodes.begin(), nodes.end());
+
+            std::vector<int> const as(a.begin(), a.end());
+            std::vector<int> const bs(b.begin(), b.end());
+            std::vector<int> expected;
+
+            auto const reuses_nodes = [&nodes](red_black_tree<int> const &t) {
+                return std::all_of(t.begin(), t.end(), [&](int const &k) {
+                    return std::binary_search(nodes.begin(), nodes.end(), &k);
+                });
+            };
+
+            WHEN("taking their union")
+            {
+                std::set_union(as.begin(), as.end(), bs.begin(), bs.end(),
+                               std::back_inserter(expected));
+                auto const u =
+                    red_black_tree<int>::set_union(std::move(a), std::move(b));
+
+                THEN("the result holds every element of either tree")
+                {
+                    REQUIRE(is_valid_red_black_tree(u));
+                    REQUIRE(std::vector<int>(u.begin(), u.end()) == expected);
+                    REQUIRE(u.size() == expected.size());
+                    REQUIRE(reuses_nodes(u));
+                    REQUIRE(a.is_empty());
+                    REQUIRE(b.is_empty());
+                }
+            }
+
+            WHEN("taking their intersection")
+            {
+                std::set_intersection(as.begin(), as.end(), bs.begin(),
+                                      bs.end(), std::back_inserter(expected));
+                auto const i = red_black_tree<int>::set_intersection(
+                    std::move(a), std::move(b));
+
+                THEN("the result holds the elements in both trees")
+                {
+                    REQUIRE_FALSE(expected.empty());
+                    REQUIRE(is_valid_red_black_tree(i));
+                    REQUIRE(std::vector<int>(i.begin(), i.end()) == expected);
+                    REQUIRE(i.size() == expected.size());
+                    REQUIRE(reuses_nodes(i));
+                }
+            }
+
+            WHEN("taking their difference")
+            {
+                std::set_difference(as.begin(), as.end(), bs.begin(),
+                                    bs.end(), std::back_inserter(expected));
+                auto const d = red_black_tree<int>::set_difference(
+                    std::move(a), std::move(b));
+
+                THEN("the result holds the elements only in the first tree")
+                {
+                    REQUIRE(is_valid_red_black_tree(d));
+                    REQUIRE(std::vector<int>(d.begin(), d.end()) == expected);
+                    REQUIRE(d.size() == expected.size());
+                    REQUIRE(reuses_nodes(d));
+                }
+            }
+
+            WHEN("combining a tree with an empty one")
+            {
+                auto const u = red_black_tree<int>::set_union(
+                    std::move(a), red_black_tree<int>());
+                auto const i = red_black_tree<int>::set_intersection(
+                    std::move(b), red_black_tree<int>());
+
+                THEN("the result is what you would expect")
+                {
+                    REQUIRE(std::vector<int>(u.begin(), u.end()) == as);
+                    REQUIRE(u.size() == as.size());
+                    REQUIRE(i.is_empty());
+                    REQUIRE(i.size() == 0);
+                }
+            }
+        }
+
+        GIVEN("two order statistic trees")
+        {
+            order_statistic_tree<int> a{1, 2, 3, 4, 5, 6};
+            order_statistic_tree<int> b{4, 5, 6, 7, 8};
+
+            WHEN("taking their union")
+            {
+                auto const u = order_statistic_tree<int>::set_union(
+                    std::move(a), std::move(b));
+
+                THEN("the subtree sizes are right")
+                {
+                    REQUIRE(u.size() == 8);
+                    REQUIRE(*u.nth(6) == 7);
+                    REQUIRE(u.rank(5) == 4);
+                }
+            }
+        }
+    }
+
+    SCENARIO("copying red black trees")
+    {
+        GIVEN("a red black tree")
+        {
+            red_black_tree<int> rb;
+            for (int i = 0; i != 100; ++i)
+            {
+                rb.add((i * 37) % 100);
+            }
+
+            WHEN("copying it")
+            {
+                auto copy = rb;
+
+                THEN("the copy has the same shape and colours")
+                {
+                    auto const original_nodes = level_order(rb);
+                    auto const copied_nodes = level_order(copy);
+                    REQUIRE(values(copied_nodes) == values(original_nodes));
+                    REQUIRE(colours(copied_nodes) == colours(original_nodes));
+                    REQUIRE(copy.size() == 100);
+                }
+
+                THEN("the copy is independent of the original")
+                {
+                    copy.erase(50);
+                    copy.add(200);
+                    REQUIRE(rb.contains(50));
+                    REQUIRE_FALSE(rb.contains(200));
+                    REQUIRE(is_valid_red_black_tree(copy));
+                    REQUIRE(is_valid_red_black_tree(rb));
+                }
+            }
+        }
+
+        GIVEN("an order statistic tree")
+        {
+            order_statistic_tree<int> rb{5, 1, 4, 2, 3};
+
+            WHEN("copying it")
+            {
+                auto const copy = rb;
+
+                THEN("the subtree sizes are copied too")
+                {
+                    REQUIRE(*copy.nth(3) == 4);
+                    REQUIRE(copy.rank(3) == 2);
+                }
+            }
+        }
+    }
+
+    SCENARIO("red black tree as a priority queue")
+    {
+        GIVEN("a red black tree under random adds, erases and pops")
+        {
+            red_black_tree<int> rb;
+            std::vector<int> expected;
+
+            std::mt19937 gen(17);
+            std::uniform_int_distribution<> dis(0, 1000);
+
+            for (int round = 0; round != 3000; ++round)
+            {
+                auto const v = dis(gen);
+                auto const pos =
+                    std::lower_bound(expected.begin(), expected.end(), v);
+
+                switch (round % 4)
+                {
+                case 0:
+                case 1:
+                    rb.add(v);
+                    if (pos == expected.end() || *pos != v)
+                    {
+                        expected.insert(pos, v);
+                    }
+                    break;
+                case 2:
+                    rb.erase(v);
+                    if (pos != expected.end() && *pos == v)
+                    {
+                        expected.erase(pos);
+                    }
+                    break;
+                default:
+                    if (!expected.empty())
+                    {
+                        REQUIRE(rb.pop_min() == expected.front());
+                        expected.erase(expected.begin());
+                    }
+                }
+
+                if (!expected.empty())
+                {
+                    REQUIRE(rb.min() == expected.front());
+                    REQUIRE(rb.max() == expected.back());
+                    REQUIRE(*rb.begin() == expected.front());
+                    REQUIRE(*--rb.end() == expected.back());
+                }
+            }
+
+            THEN("it is still a valid red black tree")
+            {
+                REQUIRE(rb.size() == expected.size());
+                REQUIRE(is_valid_red_black_tree(rb));
+            }
+        }
+    }
+
+    SCENARIO("compact red black trees")
+    {
+        GIVEN("a compact red black tree under random adds and erases")
+        {
+            compact_red_black_tree<long> rb;
+            std::set<long> expected;
+
+            std::mt19937 gen(23);
+            std::uniform_int_distribution<long> dis(0, 2000);
+            for (int round = 0; round != 6000; ++round)
+            {
+                auto const v = dis(gen);
+                if (round % 3 == 2)
+                {
+                    rb.erase(v);
+                    expected.erase(v);
+                }
+                else
+                {
+                    rb.add(v);
+                    expected.insert(v);
+                }
+            }
+
+            THEN("its nodes are a word smaller than a red_black_tree's")
+            {
+                REQUIRE(sizeof(compact_red_black_tree<long>::node_type) ==
+                        sizeof(red_black_tree<long>::node_type) -
+                            sizeof(void *));
+            }
+
+            THEN("it is a valid red black tree holding the right elements")
+            {
+                REQUIRE(is_valid_red_black_tree(rb));
+                REQUIRE(std::equal(rb.begin(), rb.end(), expected.begin(),
+                                   expected.end()));
+                REQUIRE(std::equal(rb.rbegin(), rb.rend(), expected.rbegin(),
+                                   expected.rend()));
+            }
+
+            THEN("a copy has the same colours")
+            {
+                auto const copy = rb;
+                auto c = copy.begin();
+                for (auto it = rb.begin(); it != rb.end(); ++it, ++c)
+                {
+                    REQUIRE(impl::colour_of(c.node()) ==
+                            impl::colour_of(it.node()));
+                }
+            }
+
+            THEN("it splits and joins back into valid trees")
+            {
+                auto lower = rb;
+                auto upper = lower.split(1000);
+                REQUIRE(is_valid_red_black_tree(lower));
+                REQUIRE(is_valid_red_black_tree(upper));
+
+                auto const joined = compact_red_black_tree<long>::join(
+                    std::move(lower), std::move(upper));
+                REQUIRE(is_valid_red_black_tree(joined));
+                REQUIRE(joined == rb);
+            }
+
+            THEN("nodes moved into another tree are recoloured there")
+            {
+                compact_red_black_tree<long> other;
+                for (auto it = expected.begin(); it != expected.end();
+                     std::advance(it, 2))
+                {
+                    other.insert(rb.extract(*it));
+                    if (std::next(it) == expected.end())
+                    {
+                        break;
+                    }
+                }
+                REQUIRE(is_valid_red_black_tree(rb));
+                REQUIRE(is_valid_red_black_tree(other));
+                REQUIRE(rb.size() + other.size() == expected.size());
+            }
+        }
+    }
+
+    SCENARIO("index linked red black trees")
+    {
+        GIVEN("an indexed red black tree under random adds and erases")
+        {
+            indexed_red_black_tree<int> rb;
+            std::set<int> expected;
+
+            std::mt19937 gen(24);
+            std::uniform_int_distribution<int> dis(0, 2000);
+            for (int round = 0; round != 6000; ++round)
+            {
+                auto const v = dis(gen);
+                if (round % 3 == 2)
+                {
+                    rb.erase(v);
+                    expected.erase(v);
+                }
+                else
+                {
+                    rb.add(v);
+                    expected.insert(v);
+                }
+            }
+
+            THEN("its nodes take 12 bytes of links rather than 24")
+            {
+                REQUIRE(sizeof(indexed_red_black_tree<int>::node_type) == 20);
+            }
+
+            THEN("it is a valid red black tree holding the right elements")
+            {
+                REQUIRE(is_valid_red_black_tree(rb));
+                REQUIRE(std::equal(rb.begin(), rb.end(), expected.begin(),
+                                   expected.end()));
+                REQUIRE(std::equal(rb.rbegin(), rb.rend(), expected.rbegin(),
+                                   expected.rend()));
+            }
+
+            THEN("it splits and joins back into valid trees")
+            {
+                auto lower = rb;
+                auto upper = lower.split(1000);
+                REQUIRE(is_valid_red_black_tree(lower));
+                REQUIRE(is_valid_red_black_tree(upper));
+
+                auto const joined = indexed_red_black_tree<int>::join(
+                    std::move(lower), std::move(upper));
+                REQUIRE(is_valid_red_black_tree(joined));
+                REQUIRE(joined == rb);
+            }
+        }
+    }
 } // namespace csb
 
 // i know this is technically undefined behaviour but it works and makes thigs
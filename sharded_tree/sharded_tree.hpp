@@ -0,0 +1,296 @@
+#ifndef CSB_SHARDED_TREE_HPP
+#define CSB_SHARDED_TREE_HPP
+
+#include <core/compare.hpp>
+#include <core/epoch.hpp>
+#include <red_black_tree/red_black_tree.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace csb
+{
+    /*
+     * Splits the key space into ranges and keeps each range in its own
+     * tree behind its own lock, so threads writing to different ranges
+     * never wait on each other. The trees are plain binary_trees, Tree can
+     * be any of them ordered by Compare.
+     *
+     * Which shard holds which range is kept in an immutable partition that
+     * rebalance replaces. Every operation looks its shard up under an
+     * impl::epoch::guard, locks it and then checks the partition it used is
+     * still current, so a key can never be added to a shard that has just
+     * stopped owning it. The old partition is retired to the epoch rather
+     * than freed, which means it can't be freed and reused at the same
+     * address while anyone is still checking against it
+     */
+    template <typename T, typename Compare = std::less<T>,
+              typename Tree = red_black_tree<T, Compare>>
+    class sharded_tree
+    {
+      public:
+        using value_type = T;
+        using key_compare = Compare;
+        using tree_type = Tree;
+
+        /*
+         * one shard per range between consecutive bounds plus one either
+         * side, bounds must be sorted and unique. Shard i holds the keys k
+         * with bounds[i - 1] <= k < bounds[i]
+         */
+        explicit sharded_tree(std::vector<T> bounds,
+                              Compare const &compare = Compare())
+              : shards(bounds.size() + 1),
+                current(new partition{std::move(bounds)}),
+                compare(compare)
+        {
+        }
+
+        sharded_tree(sharded_tree const &) = delete;
+        sharded_tree &operator=(sharded_tree const &) = delete;
+
+        /** must not race with anything else using the tree */
+        ~sharded_tree() { delete current.load(); }
+
+        void add(T t)
+        {
+            with_shard(t, [&t](Tree &tree) { tree.add(std::move(t)); });
+        }
+
+        void erase(T const &t)
+        {
+            with_shard(t, [&t](Tree &tree) { tree.erase(t); });
+        }
+
+        bool contains(T const &t) const
+        {
+            return with_shard(
+                t, [&t](Tree const &tree) { return tree.contains(t); });
+        }
+
+        /** a copy of the element equivalent to t, if there is one */
+        std::optional<T> find(T const &t) const
+        {
+            return with_shard(t, [&t](Tree const &tree) {
+                auto const it = tree.find(t);
+                return it == tree.end() ? std::nullopt
+                                        : std::optional<T>(*it);
+            });
+        }
+
+        /*
+         * visits every element in key order. Every shard is locked for the
+         * duration so that it sees a single consistent state of the tree
+         */
+        template <typename Callable>
+        void for_each(Callable const &visiter) const
+        {
+            auto const locks = lock_all();
+            for (auto const &s : shards)
+            {
+                s.tree.inorder_traverse(visiter);
+            }
+        }
+
+        std::size_t size() const
+        {
+            auto const locks = lock_all();
+            std::size_t n = 0;
+            for (auto const &s : shards)
+            {
+                n += s.tree.size();
+            }
+            return n;
+        }
+
+        bool is_empty() const { return size() == 0; }
+
+        std::size_t shard_count() const { return shards.size(); }
+
+        /** the number of elements in each shard, for monitoring */
+        std::vector<std::size_t> shard_sizes() const
+        {
+            auto const locks = lock_all();
+            std::vector<std::size_t> sizes;
+            for (auto const &s : shards)
+            {
+                sizes.push_back(s.tree.size());
+            }
+            return sizes;
+        }
+
+        /*
+         * finds the shard that has had the most operations since the last
+         * rebalance and, if it has had more than hot_factor times its share,
+         * hands half of its elements to whichever neighbour has had fewer.
+         * The elements move with a split and a join, O(log n), though
+         * finding the middle of the hot shard walks half of it. Only the
+         * two shards involved are locked. Returns whether anything moved
+         */
+        bool rebalance(double hot_factor = 2.0)
+        {
+            // each rebalance derives the next partition from the current
+            std::lock_guard<std::mutex> rebalancing(rebalance_mutex);
+            if (shards.size() < 2)
+            {
+                return false;
+            }
+
+            std::size_t hot = 0;
+            std::size_t total = 0;
+            for (std::size_t i = 0; i != shards.size(); ++i)
+            {
+                auto const ops = shards[i].ops.load();
+                total += ops;
+                if (ops > shards[hot].ops.load())
+                {
+                    hot = i;
+                }
+            }
+            if (shards[hot].ops.load() <=
+                hot_factor * total / shards.size())
+            {
+                return false;
+            }
+
+            auto const ops_of = [this](std::size_t i) {
+                return shards[i].ops.load();
+            };
+            auto const to_right =
+                hot == 0 ||
+                (hot + 1 != shards.size() && ops_of(hot + 1) < ops_of(hot - 1));
+            auto const left = to_right ? hot : hot - 1;
+            auto &l = shards[left];
+            auto &r = shards[left + 1];
+
+            std::scoped_lock lock(l.m, r.m);
+            auto &from = to_right ? l.tree : r.tree;
+            if (from.size() < 2)
+            {
+                return false;
+            }
+
+            // split the hot shard in the middle and join the half next to
+            // the neighbour onto it
+            auto const mid = middle_of(from);
+            auto upper = from.split(mid);
+            if (to_right)
+            {
+                r.tree = Tree::join(std::move(upper), std::move(r.tree));
+            }
+            else
+            {
+                l.tree = Tree::join(std::move(l.tree), std::move(from));
+                r.tree = std::move(upper);
+            }
+
+            auto const old = current.load();
+            auto const next = new partition(*old);
+            next->bounds[left] = mid;
+            current.store(next);
+            impl::epoch::retire(old);
+
+            for (auto &s : shards)
+            {
+                s.ops.store(0);
+            }
+            return true;
+        }
+
+      private:
+        /*
+         * trees that keep subtree sizes find their middle element in
+         * O(log n), the rest have to walk halfway along
+         */
+        static T const &middle_of(Tree const &tree)
+        {
+            if constexpr (impl::is_order_statistic_v<
+                              typename Tree::balancing_policy>)
+            {
+                return *tree.nth(tree.size() / 2);
+            }
+            else
+            {
+                return *std::next(tree.begin(), tree.size() / 2);
+            }
+        }
+
+        struct partition
+        {
+            std::vector<T> bounds;
+        };
+
+        // keep each shard's lock and counter off its neighbours' cache
+        // lines, or the shards would contend just by being next to each
+        // other
+        struct alignas(64) shard
+        {
+            mutable std::mutex m;
+            Tree tree;
+            mutable std::atomic<std::size_t> ops{0};
+        };
+
+        std::size_t shard_of(partition const &p, T const &t) const
+        {
+            auto const it = std::upper_bound(
+                p.bounds.begin(), p.bounds.end(), t,
+                [this](T const &l, T const &r) {
+                    return impl::compare_less(compare, l, r);
+                });
+            return static_cast<std::size_t>(it - p.bounds.begin());
+        }
+
+        /** runs f on the tree of the shard that owns t, under its lock */
+        template <typename F> auto with_shard(T const &t, F const &f) const
+        {
+            impl::epoch::guard guard;
+            while (true)
+            {
+                auto const p = current.load();
+                auto &s = shards[shard_of(*p, t)];
+                std::lock_guard<std::mutex> lock(s.m);
+                // rebalance changes the partition while holding the locks
+                // of the shards it moves elements between
+                if (current.load() == p)
+                {
+                    s.ops.fetch_add(1, std::memory_order_relaxed);
+                    return f(s.tree);
+                }
+            }
+        }
+
+        template <typename F> auto with_shard(T const &t, F const &f)
+        {
+            return std::as_const(*this).with_shard(
+                t, [&f](Tree const &tree) {
+                    return f(const_cast<Tree &>(tree));
+                });
+        }
+
+        /** locks every shard, in order so as not to deadlock rebalance */
+        std::vector<std::unique_lock<std::mutex>> lock_all() const
+        {
+            std::vector<std::unique_lock<std::mutex>> locks;
+            for (auto const &s : shards)
+            {
+                locks.emplace_back(s.m);
+            }
+            return locks;
+        }
+
+        std::vector<shard> shards;
+        std::atomic<partition *> current;
+        std::mutex rebalance_mutex;
+        Compare compare;
+    };
+} // namespace csb
+
+#endif // CSB_SHARDED_TREE_HPP
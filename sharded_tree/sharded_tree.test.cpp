@@ -0,0 +1,213 @@
+#include "sharded_tree/sharded_tree.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace csb::test
+{
+    namespace
+    {
+        template <typename T>
+        std::vector<T> values(sharded_tree<T> const &tree)
+        {
+            std::vector<T> v;
+            tree.for_each([&v](T const &t) { v.push_back(t); });
+            return v;
+        }
+    } // namespace
+
+    SCENARIO("sharded tree on a single thread")
+    {
+        GIVEN("a tree sharded at 100, 200 and 300")
+        {
+            sharded_tree<int> tree({100, 200, 300});
+            std::set<int> expected;
+
+            std::mt19937 gen(9);
+            std::uniform_int_distribution<> dis(-50, 400);
+            for (int round = 0; round != 3000; ++round)
+            {
+                auto const v = dis(gen);
+                if (round % 3 == 2)
+                {
+                    tree.erase(v);
+                    expected.erase(v);
+                }
+                else
+                {
+                    tree.add(v);
+                    expected.insert(v);
+                }
+            }
+
+            THEN("iterating crosses the shards in key order")
+            {
+                REQUIRE(tree.shard_count() == 4);
+                REQUIRE(tree.size() == expected.size());
+                REQUIRE(values(tree) ==
+                        std::vector<int>(expected.begin(), expected.end()));
+            }
+
+            THEN("each shard only holds its own range")
+            {
+                auto const sizes = tree.shard_sizes();
+                auto const count = [&expected](int lo, int hi) {
+                    return static_cast<std::size_t>(
+                        std::distance(expected.lower_bound(lo),
+                                      expected.lower_bound(hi)));
+                };
+                REQUIRE(sizes == std::vector<std::size_t>{
+                                     count(-100, 100), count(100, 200),
+                                     count(200, 300), count(300, 500)});
+            }
+
+            THEN("contains and find agree with std::set")
+            {
+                for (int v = -60; v != 410; ++v)
+                {
+                    auto const in = expected.count(v) == 1;
+                    REQUIRE(tree.contains(v) == in);
+                    REQUIRE(tree.find(v) == (in ? std::optional<int>(v)
+                                                : std::nullopt));
+                }
+            }
+        }
+
+        GIVEN("a tree where every operation lands in one shard")
+        {
+            sharded_tree<int> tree({1000, 2000, 3000});
+            for (int i = 0; i != 500; ++i)
+            {
+                tree.add(1000 + 2 * i);
+            }
+
+            WHEN("it is rebalanced")
+            {
+                REQUIRE(tree.rebalance());
+
+                THEN("half of the hot shard moves to a neighbour")
+                {
+                    auto const sizes = tree.shard_sizes();
+                    REQUIRE(sizes[1] == 250);
+                    REQUIRE(sizes[0] + sizes[2] == 250);
+                }
+
+                THEN("every element can still be found, in order")
+                {
+                    std::vector<int> expected;
+                    for (int i = 0; i != 500; ++i)
+                    {
+                        expected.push_back(1000 + 2 * i);
+                        REQUIRE(tree.contains(1000 + 2 * i));
+                        REQUIRE_FALSE(tree.contains(1001 + 2 * i));
+                    }
+                    REQUIRE(values(tree) == expected);
+                }
+
+                THEN("the counts are reset so it does not go again")
+                {
+                    REQUIRE_FALSE(tree.rebalance());
+                }
+            }
+        }
+
+        GIVEN("shards that keep subtree sizes and one busy shard")
+        {
+            sharded_tree<int, std::less<int>, order_statistic_tree<int>> tree(
+                {1000, 2000, 3000});
+            for (int i = 0; i != 500; ++i)
+            {
+                tree.add(1000 + 2 * i);
+            }
+
+            WHEN("it is rebalanced")
+            {
+                REQUIRE(tree.rebalance());
+
+                THEN("half of the hot shard moves to a neighbour")
+                {
+                    auto const sizes = tree.shard_sizes();
+                    REQUIRE(sizes[1] == 250);
+                    REQUIRE(sizes[0] + sizes[2] == 250);
+                    for (int i = 0; i != 500; ++i)
+                    {
+                        REQUIRE(tree.contains(1000 + 2 * i));
+                    }
+                }
+            }
+        }
+
+        GIVEN("a tree with evenly spread operations")
+        {
+            sharded_tree<int> tree({10, 20, 30});
+            for (int i = 0; i != 40; ++i)
+            {
+                tree.add(i);
+            }
+
+            THEN("there is nothing to rebalance")
+            {
+                REQUIRE_FALSE(tree.rebalance());
+            }
+        }
+    }
+
+    SCENARIO("sharded tree on many threads")
+    {
+        GIVEN("writers on disjoint keys while another thread rebalances")
+        {
+            constexpr int threads = 6;
+            constexpr int per_thread = 3000;
+            sharded_tree<int> tree({5000, 10000});
+
+            std::vector<std::thread> writers;
+            for (int t = 0; t != threads; ++t)
+            {
+                writers.emplace_back([&tree, t]() {
+                    for (int i = 0; i != per_thread; ++i)
+                    {
+                        tree.add(i * threads + t);
+                        if (i % 3 == 0)
+                        {
+                            tree.erase(i * threads + t);
+                        }
+                    }
+                });
+            }
+            std::thread rebalancer([&tree]() {
+                for (int i = 0; i != 200; ++i)
+                {
+                    tree.rebalance(1.2);
+                    std::this_thread::yield();
+                }
+            });
+            for (auto &w : writers)
+            {
+                w.join();
+            }
+            rebalancer.join();
+
+            THEN("nothing is lost or duplicated")
+            {
+                std::vector<int> expected;
+                for (int k = 0; k != per_thread * threads; ++k)
+                {
+                    if ((k / threads) % 3 != 0)
+                    {
+                        expected.push_back(k);
+                    }
+                }
+                REQUIRE(values(tree) == expected);
+                for (auto k : expected)
+                {
+                    REQUIRE(tree.contains(k));
+                }
+            }
+        }
+    }
+} // namespace csb::test